@@ -0,0 +1,272 @@
+#include "StepSimulator.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+
+namespace exawind {
+
+namespace {
+
+//! Clocks of the sets of ranks that run the same solvers
+class RankClocks
+{
+public:
+    //! Rank ranges [first, last) of the solvers
+    explicit RankClocks(const std::vector<std::pair<int, int>>& ranges)
+    {
+        std::set<int> bounds;
+        for (const auto& r : ranges) {
+            bounds.insert(r.first);
+            bounds.insert(r.second);
+        }
+        m_bounds.assign(bounds.begin(), bounds.end());
+        m_clocks.assign(m_bounds.size() - 1, 0.0);
+        for (const auto& r : ranges) {
+            std::vector<int> segs;
+            for (size_t k = 0; k + 1 < m_bounds.size(); ++k) {
+                if ((m_bounds[k] >= r.first) && (m_bounds[k + 1] <= r.second))
+                    segs.push_back(static_cast<int>(k));
+            }
+            m_solver_segments.push_back(segs);
+        }
+    }
+
+    //! Run a phase of a solver once all its ranks are done with the previous
+    //! one (solver phases synchronize their ranks internally)
+    void local(const int solver, const double duration)
+    {
+        const auto& segs = m_solver_segments[solver];
+        double start = 0.0;
+        for (const int k : segs) start = std::max(start, m_clocks[k]);
+        for (const int k : segs) {
+            m_idle += (start - m_clocks[k]) * width(k);
+            m_clocks[k] = start + duration;
+        }
+    }
+
+    //! Run a phase involving all ranks once they have all reached it
+    void collective(const double duration)
+    {
+        const double start = time();
+        for (size_t k = 0; k < m_clocks.size(); ++k) {
+            m_idle += (start - m_clocks[k]) * width(k);
+            m_clocks[k] = start + duration;
+        }
+    }
+
+    //! Time at which the last rank is done
+    double time() const
+    {
+        return *std::max_element(m_clocks.begin(), m_clocks.end());
+    }
+
+    //! Rank time spent waiting, including the wait for the last rank
+    double idle() const
+    {
+        const double end = time();
+        double idle = m_idle;
+        for (size_t k = 0; k < m_clocks.size(); ++k) {
+            idle += (end - m_clocks[k]) * width(k);
+        }
+        return idle;
+    }
+
+private:
+    int width(const size_t k) const { return m_bounds[k + 1] - m_bounds[k]; }
+
+    std::vector<int> m_bounds;
+    std::vector<double> m_clocks;
+    std::vector<std::vector<int>> m_solver_segments;
+    double m_idle{0.0};
+};
+
+} // namespace
+
+RunConfig RunConfig::read(const YAML::Node& node, const RunConfig& defaults)
+{
+    RunConfig config(defaults);
+    if (node["name"]) config.name = node["name"].as<std::string>();
+    if (node["mpi_ranks"]) config.mpi_ranks = node["mpi_ranks"].as<int>();
+    if (node["ranks"]) {
+        for (const auto& r : node["ranks"]) {
+            config.ranks[r.first.as<std::string>()] = r.second.as<int>();
+        }
+    }
+    if (node["nonlinear_iterations"]) {
+        config.nonlinear_its = node["nonlinear_iterations"].as<int>();
+    }
+    if (node["additional_picard_iterations"]) {
+        config.picard_its = node["additional_picard_iterations"].as<int>();
+    }
+    if (node["connectivity_interval"]) {
+        config.conn_interval = node["connectivity_interval"].as<int>();
+    }
+    if (node["coupling_mode"]) {
+        const auto mode = node["coupling_mode"].as<std::string>();
+        if ((mode != "lockstep") && (mode != "lagged")) {
+            throw std::runtime_error(
+                "Unknown coupling mode: " + mode +
+                ". Valid options are lockstep and lagged");
+        }
+        config.lagged = (mode == "lagged");
+    }
+    if ((config.nonlinear_its < 1) || (config.picard_its < 0) ||
+        (config.conn_interval < 1)) {
+        throw std::runtime_error(
+            "Configuration " + config.name +
+            " needs at least one nonlinear iteration, a non-negative number "
+            "of Picard iterations and a positive connectivity interval");
+    }
+    return config;
+}
+
+StepSimulator::StepSimulator(
+    const TimingData& data,
+    const RunConfig& recorded,
+    const double scaling_exponent)
+    : m_exponent(scaling_exponent)
+{
+    // The timers of the iteration phases and of the solution exchange add up
+    // over a step. The connectivity timers and the packing and unpacking of
+    // the exchanged fields only hold the last update, they are written at
+    // every step and are per-event costs.
+    const double nonlin = recorded.nonlinear_its;
+    const double picard = recorded.picard_its;
+    const double conn_frac = 1.0 / recorded.conn_interval;
+    const double exchanges = recorded.lagged
+                                 ? 1.0 + conn_frac
+                                 : nonlin + (recorded.picard_its > 0 ? 1 : 0);
+
+    for (const auto& name : data.solvers()) {
+        const auto it = recorded.ranks.find(name);
+        if (it == recorded.ranks.end()) {
+            throw std::runtime_error(
+                "No rank count for " + name + " in the recorded configuration");
+        }
+        SolverCosts costs;
+        costs.name = name;
+        costs.ranks = it->second;
+        costs.pre_it = data.phase(name, "Pre").max / nonlin;
+        costs.solve_it = data.phase(name, "Solve").max / nonlin;
+        if (picard > 0) {
+            costs.picard_it =
+                data.phase(name, "AdditionalPicardIterations").max / picard;
+        }
+        costs.register_exchange = data.phase(name, "Register").max;
+        costs.update_exchange = data.phase(name, "Update").max;
+        costs.post = data.phase(name, "Post").max;
+        // The mesh motion measurement runs before the connectivity
+        costs.pre_conn = data.phase(name, "PreConn").max +
+                         data.phase(name, "MeshMotion").max;
+        costs.post_conn = data.phase(name, "PostConn").max;
+        m_costs.push_back(costs);
+    }
+    if (m_costs.empty()) {
+        throw std::runtime_error("No solver timings found");
+    }
+
+    m_conn = data.phase("Tioga", "Connectivity").max;
+    m_exchange = data.phase("Tioga", "SolExchange").max / exchanges;
+    // The step timer is the only driver timer, which the timings output
+    // labels Total instead of TimeStep
+    m_recorded_step = data.has_phase("Exawind", "TimeStep")
+                          ? data.phase("Exawind", "TimeStep").max
+                          : data.phase("Exawind", "Total").max;
+}
+
+StepPrediction
+StepSimulator::predict(const RunConfig& config, const int num_steps) const
+{
+    // Rank ranges of the solvers, laid out as in the exawind app
+    const int nsolvers = static_cast<int>(m_costs.size());
+    std::vector<int> ranks(nsolvers);
+    std::vector<double> scale(nsolvers);
+    int num_amr = 0;
+    int num_nalu = 0;
+    for (int s = 0; s < nsolvers; ++s) {
+        const auto& name = m_costs[s].name;
+        const auto it = config.ranks.find(name);
+        ranks[s] = (it != config.ranks.end()) ? it->second : 0;
+        if ((ranks[s] < 1) || (ranks[s] > config.mpi_ranks)) {
+            throw std::runtime_error(
+                "Invalid rank count for " + name + " in configuration " +
+                config.name);
+        }
+        scale[s] = std::pow(
+            static_cast<double>(m_costs[s].ranks) / ranks[s], m_exponent);
+        if (name == "AMR-Wind") {
+            num_amr = ranks[s];
+        } else {
+            num_nalu += ranks[s];
+        }
+    }
+    if ((num_nalu > config.mpi_ranks) ||
+        (num_amr + num_nalu < config.mpi_ranks)) {
+        throw std::runtime_error(
+            "The solver ranks of configuration " + config.name +
+            " do not cover the " + std::to_string(config.mpi_ranks) +
+            " MPI ranks");
+    }
+    std::vector<std::pair<int, int>> ranges;
+    int next_nalu = config.mpi_ranks - num_nalu;
+    for (int s = 0; s < nsolvers; ++s) {
+        if (m_costs[s].name == "AMR-Wind") {
+            ranges.emplace_back(0, num_amr);
+        } else {
+            ranges.emplace_back(next_nalu, next_nalu + ranks[s]);
+            next_nalu += ranks[s];
+        }
+    }
+
+    RankClocks clocks(ranges);
+    std::vector<double> busy(nsolvers, 0.0);
+    auto run_solvers = [&](double SolverCosts::*phase) {
+        for (int s = 0; s < nsolvers; ++s) {
+            const double duration = m_costs[s].*phase * scale[s];
+            clocks.local(s, duration);
+            busy[s] += duration;
+        }
+    };
+    auto exchange = [&]() {
+        run_solvers(&SolverCosts::register_exchange);
+        clocks.collective(m_exchange);
+        run_solvers(&SolverCosts::update_exchange);
+    };
+
+    for (int nt = 0; nt < num_steps; ++nt) {
+        const bool new_connectivity = (nt % config.conn_interval) == 0;
+        for (int inonlin = 0; inonlin < config.nonlinear_its; ++inonlin) {
+            run_solvers(&SolverCosts::pre_it);
+            if (new_connectivity && (inonlin == 0)) {
+                run_solvers(&SolverCosts::pre_conn);
+                clocks.collective(m_conn);
+                run_solvers(&SolverCosts::post_conn);
+                // New fringe points need data even with lagged coupling
+                if (config.lagged) exchange();
+            }
+            if (!config.lagged) exchange();
+            run_solvers(&SolverCosts::solve_it);
+        }
+        if (config.picard_its > 0) {
+            if (!config.lagged) exchange();
+            for (int ipic = 0; ipic < config.picard_its; ++ipic) {
+                run_solvers(&SolverCosts::picard_it);
+            }
+        }
+        run_solvers(&SolverCosts::post);
+        if (config.lagged) exchange();
+    }
+
+    StepPrediction pred;
+    const double total = clocks.time();
+    pred.step_time = total / num_steps;
+    pred.idle_fraction = clocks.idle() / (total * config.mpi_ranks);
+    for (int s = 0; s < nsolvers; ++s) {
+        pred.busy[m_costs[s].name] = busy[s] / num_steps;
+    }
+    return pred;
+}
+
+} // namespace exawind
@@ -0,0 +1,95 @@
+#ifndef STEPSIMULATOR_H
+#define STEPSIMULATOR_H
+
+#include "TimingData.h"
+#include "yaml-cpp/yaml.h"
+#include <map>
+#include <string>
+#include <vector>
+
+namespace exawind {
+
+//! Rank layout, iteration counts and coupling of a coupled run
+struct RunConfig
+{
+    std::string name{"recorded"};
+    //! Total number of MPI ranks
+    int mpi_ranks{1};
+    //! Number of ranks of every solver. As in the exawind app, AMR-Wind uses
+    //! the first ranks and the Nalu-Wind instances the last ones.
+    std::map<std::string, int> ranks;
+    int nonlinear_its{1};
+    int picard_its{0};
+    //! Timesteps between connectivity updates
+    int conn_interval{1};
+    //! Lagged coupling: one exchange per step instead of one per iteration
+    bool lagged{false};
+
+    //! Read the options given in a YAML node, the others keep the values of
+    //! the defaults
+    static RunConfig read(const YAML::Node& node, const RunConfig& defaults);
+};
+
+//! Predicted timings of a run configuration
+struct StepPrediction
+{
+    //! Wall time per timestep (s)
+    double step_time{0.0};
+    //! Fraction of the rank time spent waiting at synchronizations
+    double idle_fraction{0.0};
+    //! Time per timestep of the slowest rank of every solver (s)
+    std::map<std::string, double> busy;
+};
+
+//! Discrete-event model of the timestep loop of the exawind driver
+//!
+//! The recorded timings give the cost of every phase of a solver (stage
+//! work, solve, packing and unpacking of the exchanged fields, connectivity
+//! work) per iteration, exchange or connectivity update. A timestep of a
+//! run configuration is then replayed as the driver runs it: the phases of
+//! each solver run in order on its ranks, and the TIOGA connectivity and
+//! solution exchanges wait for all ranks. Ranks shared by several solvers
+//! run their phases one after the other.
+//!
+//! Solver phases scale with (recorded ranks / ranks)^exponent, the TIOGA
+//! phases keep their recorded cost.
+class StepSimulator
+{
+public:
+    StepSimulator(
+        const TimingData& data,
+        const RunConfig& recorded,
+        const double scaling_exponent);
+
+    //! Replay num_steps timesteps of a run configuration
+    StepPrediction predict(const RunConfig& config, const int num_steps) const;
+
+    //! Measured wall time per timestep of the recorded run (s)
+    double recorded_step_time() const { return m_recorded_step; }
+
+private:
+    //! Costs of the phases of a solver on its recorded ranks (s)
+    struct SolverCosts
+    {
+        std::string name;
+        int ranks{1};
+        double pre_it{0.0};
+        double solve_it{0.0};
+        double picard_it{0.0};
+        double register_exchange{0.0};
+        double update_exchange{0.0};
+        double post{0.0};
+        double pre_conn{0.0};
+        double post_conn{0.0};
+    };
+
+    std::vector<SolverCosts> m_costs;
+    //! TIOGA connectivity update and solution exchange (s)
+    double m_conn{0.0};
+    double m_exchange{0.0};
+    double m_recorded_step{0.0};
+    double m_exponent;
+};
+
+} // namespace exawind
+#endif /* STEPSIMULATOR_H */
@@ -0,0 +1,118 @@
+#include "TimingData.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+namespace exawind {
+
+namespace {
+
+struct Record
+{
+    std::string solver;
+    std::string name;
+    int step;
+    double avg;
+    double max;
+};
+
+//! Driver-level timer groups, everything else is a CFD solver
+bool is_driver(const std::string& solver)
+{
+    return (solver == "Exawind") || (solver == "Tioga") ||
+           (solver == "Coupling");
+}
+
+} // namespace
+
+TimingData::TimingData(const std::string& filename, const int skip_steps)
+{
+    std::ifstream inp(filename);
+    if (!inp.is_open()) {
+        throw std::runtime_error("Unable to open timings file " + filename);
+    }
+
+    // Header lines and anything else that is not a timer line are skipped
+    std::vector<Record> records;
+    std::set<int> steps;
+    std::string line;
+    while (std::getline(inp, line)) {
+        std::istringstream fields(line);
+        std::string key;
+        Record rec;
+        double min;
+        if (!(fields >> key >> rec.step >> min >> rec.avg >> rec.max)) {
+            continue;
+        }
+        const auto sep = key.find("::");
+        if (sep == std::string::npos) continue;
+        rec.solver = key.substr(0, sep);
+        rec.name = key.substr(sep + 2);
+        records.push_back(rec);
+        steps.insert(rec.step);
+    }
+
+    if (static_cast<int>(steps.size()) <= skip_steps) {
+        throw std::runtime_error(
+            "No timesteps left in " + filename + " after skipping " +
+            std::to_string(skip_steps));
+    }
+    const int first_step = *std::next(steps.begin(), skip_steps);
+    m_num_steps = static_cast<int>(steps.size()) - skip_steps;
+
+    for (const auto& rec : records) {
+        auto& timing = m_phases[rec.solver][rec.name];
+        timing.last = rec.max;
+        if (rec.step < first_step) continue;
+        timing.max += rec.max;
+        timing.avg += rec.avg;
+        ++timing.num_steps;
+    }
+    for (auto& solver : m_phases) {
+        for (auto& ph : solver.second) {
+            if (ph.second.num_steps < 1) continue;
+            ph.second.max /= ph.second.num_steps;
+            ph.second.avg /= ph.second.num_steps;
+        }
+    }
+}
+
+PhaseTiming
+TimingData::phase(const std::string& solver, const std::string& name) const
+{
+    if (!has_phase(solver, name)) return PhaseTiming();
+    return m_phases.at(solver).at(name);
+}
+
+bool TimingData::has_phase(
+    const std::string& solver, const std::string& name) const
+{
+    const auto it = m_phases.find(solver);
+    return (it != m_phases.end()) && (it->second.count(name) > 0);
+}
+
+std::vector<std::string> TimingData::solvers() const
+{
+    // Same order as the solver registration in the exawind app
+    std::vector<std::pair<int, std::string>> order;
+    const std::string nalu = "Nalu-Wind-";
+    for (const auto& solver : m_phases) {
+        const auto& name = solver.first;
+        if (is_driver(name)) continue;
+        const int key = (name.rfind(nalu, 0) == 0)
+                            ? std::stoi(name.substr(nalu.size()))
+                            : std::numeric_limits<int>::max();
+        order.emplace_back(key, name);
+    }
+    std::sort(order.begin(), order.end());
+
+    std::vector<std::string> names;
+    for (const auto& ord : order) names.push_back(ord.second);
+    return names;
+}
+
+} // namespace exawind
@@ -0,0 +1,53 @@
+#ifndef TIMINGDATA_H
+#define TIMINGDATA_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace exawind {
+
+//! Statistics of one timer over the recorded timesteps
+struct PhaseTiming
+{
+    //! Mean over the steps of the slowest rank (s)
+    double max{0.0};
+    //! Mean over the steps of the rank average (s)
+    double avg{0.0};
+    //! Slowest rank at the last recorded step, e.g., for counters
+    double last{0.0};
+    int num_steps{0};
+};
+
+//! Per-solver, per-phase timings read from a timings.dat file
+//!
+//! Every line of the file gives the min, average and max over the ranks of
+//! one timer (Solver::Phase) at one reported timestep.
+class TimingData
+{
+public:
+    //! Read the timer lines of the steps following the first skip_steps
+    //! reported steps
+    TimingData(const std::string& filename, const int skip_steps);
+
+    //! Statistics of a timer, zero if it was not recorded
+    PhaseTiming
+    phase(const std::string& solver, const std::string& name) const;
+
+    //! True if a timer was recorded
+    bool has_phase(const std::string& solver, const std::string& name) const;
+
+    //! Names of the CFD solvers found in the file: the Nalu-Wind instances
+    //! in order, then AMR-Wind
+    std::vector<std::string> solvers() const;
+
+    //! Number of timesteps used for the statistics
+    int num_steps() const { return m_num_steps; }
+
+private:
+    std::map<std::string, std::map<std::string, PhaseTiming>> m_phases;
+    int m_num_steps{0};
+};
+
+} // namespace exawind
+#endif /* TIMINGDATA_H */
@@ -0,0 +1,93 @@
+#include "StepSimulator.h"
+#include "TimingData.h"
+#include "yaml-cpp/yaml.h"
+#include <iomanip>
+#include <iostream>
+
+static std::string usage(std::string name)
+{
+    return "usage: " + name + " input_file\n" +
+           "\t-h,--help\t\tShow this help message\n" +
+           "Predicts the timestep time of exawind runs from the timings.dat "
+           "file of a recorded run\n";
+}
+
+//! One line of the prediction table
+static void print_prediction(
+    const exawind::RunConfig& config,
+    const exawind::StepPrediction& pred,
+    const double reference)
+{
+    std::cout << std::left << std::setw(20) << config.name << std::right
+              << std::fixed << std::setprecision(4) << std::setw(12)
+              << pred.step_time << std::setw(10) << std::setprecision(2)
+              << reference / pred.step_time << std::setw(10)
+              << 100.0 * pred.idle_fraction << "%";
+    for (const auto& busy : pred.busy) {
+        std::cout << "  " << busy.first << " " << std::setprecision(4)
+                  << busy.second << " on " << config.ranks.at(busy.first);
+    }
+    std::cout << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2) {
+        std::cerr << usage(argv[0]);
+        return 1;
+    }
+    const std::string arg = argv[1];
+    if ((arg == "-h") || (arg == "--help")) {
+        std::cout << usage(argv[0]);
+        return 0;
+    }
+
+    try {
+        const YAML::Node doc(YAML::LoadFile(arg));
+        const YAML::Node node = doc["exawind_sim"];
+        if (!node || !node["recorded"]) {
+            throw std::runtime_error(
+                "The input file needs an exawind_sim section describing the "
+                "recorded run");
+        }
+        const std::string timings_file =
+            node["timings_file"] ? node["timings_file"].as<std::string>()
+                                 : "timings.dat";
+        const int skip_steps =
+            node["skip_steps"] ? node["skip_steps"].as<int>() : 1;
+        const int num_steps =
+            node["num_steps"] ? node["num_steps"].as<int>() : 100;
+        const double scaling_exponent =
+            node["strong_scaling_exponent"]
+                ? node["strong_scaling_exponent"].as<double>()
+                : 1.0;
+
+        const exawind::TimingData data(timings_file, skip_steps);
+        const auto recorded = exawind::RunConfig::read(
+            node["recorded"], exawind::RunConfig());
+        const exawind::StepSimulator sim(data, recorded, scaling_exponent);
+
+        std::cout << "Replaying " << data.num_steps() << " timesteps of "
+                  << timings_file << ", measured "
+                  << sim.recorded_step_time() << " s per timestep"
+                  << std::endl
+                  << std::left << std::setw(20) << "Configuration"
+                  << std::right << std::setw(12) << "Step (s)"
+                  << std::setw(10) << "Speedup" << std::setw(11) << "Idle"
+                  << "  Solver busy time (s) on ranks" << std::endl;
+
+        // The model of the recorded run is the reference of the what-if
+        // configurations, its error tells how far to trust them
+        const auto reference = sim.predict(recorded, num_steps);
+        print_prediction(recorded, reference, reference.step_time);
+        for (const auto& scenario : node["scenarios"]) {
+            const auto config = exawind::RunConfig::read(scenario, recorded);
+            print_prediction(
+                config, sim.predict(config, num_steps), reference.step_time);
+        }
+    } catch (const std::exception& err) {
+        std::cerr << err.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -2,6 +2,7 @@
 #include "NaluWind.h"
 #include "OversetSimulation.h"
 #include "MPIUtilities.h"
+#include "AutoPartition.h"
 #include "mpi.h"
 #include "yaml-editor.h"
 #include "yaml-cpp/yaml.h"
@@ -35,13 +36,100 @@ replace_extension(const std::string& filepath, const std::string& newExt)
     }
 }
 
+//! Nalu-Wind input of an instance with the replacements applied
+static YAML::Node
+load_nalu_input(const YAML::Node& instance, const YAML::Node& replace_all)
+{
+    const std::string inpfile =
+        instance.IsMap() ? instance["base_input_file"].as<std::string>()
+                         : instance.as<std::string>();
+    YAML::Node nalu_yaml = YAML::LoadFile(inpfile);
+    // replace in order so instance can overwrite all
+    if (replace_all) {
+        YEDIT::find_and_replace(nalu_yaml, replace_all);
+    }
+    if (instance.IsMap() && instance["replace"]) {
+        YEDIT::find_and_replace(nalu_yaml, instance["replace"]);
+    }
+    return nalu_yaml;
+}
+
+//! Iteration count given by key, or fallback if it is not given
+static int iteration_count(
+    const YAML::Node& node,
+    const std::string& key,
+    const int fallback,
+    const int min_count)
+{
+    if (!node[key]) return fallback;
+    const int count = node[key].as<int>();
+    if (count < min_count) {
+        throw std::runtime_error(
+            key + " must be at least " + std::to_string(min_count) +
+            ", got " + std::to_string(count));
+    }
+    return count;
+}
+
+//! Position of a field in the exchanged field lists of the solvers, -1 if no
+//! solver exchanges it
+static int exchange_position(
+    const std::string& field,
+    const std::vector<std::vector<std::string>>& field_lists)
+{
+    int position = -1;
+    for (const auto& fields : field_lists) {
+        const auto it = std::find(fields.begin(), fields.end(), field);
+        if (it == fields.end()) continue;
+        const int pos = static_cast<int>(it - fields.begin());
+        if ((position >= 0) && (pos != position)) {
+            throw std::runtime_error(
+                "Field " + field +
+                " is exchanged at different positions by the solvers");
+        }
+        position = pos;
+    }
+    return position;
+}
+
+//! Look-ahead connectivity, overlapped exchanges and lagged coupling run
+//! TIOGA on a helper thread, which requires full thread support from MPI
+static bool needs_thread_multiple(int argc, char** argv)
+{
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if ((arg == "--awind") || (arg == "--nwind")) {
+            ++i;
+        } else if (arg.rfind("-", 0) != 0) {
+            try {
+                const YAML::Node node = YAML::LoadFile(arg)["exawind"];
+                for (const auto* opt :
+                     {"lookahead_connectivity", "overlap_exchange"}) {
+                    if (node[opt] && node[opt].as<bool>()) return true;
+                }
+                return node["coupling_mode"] &&
+                       (node["coupling_mode"].as<std::string>() == "lagged");
+            } catch (const YAML::Exception&) {
+                // reported when the input file is read
+                return false;
+            }
+        }
+    }
+    return false;
+}
+
 int main(int argc, char** argv)
 {
 // Workaround for MPI issue on OLCF Frontier machine
 #ifdef EXAWIND_ENABLE_ROCM
     hipInit(0);
 #endif
-    MPI_Init(&argc, &argv);
+    if (needs_thread_multiple(argc, argv)) {
+        int provided;
+        MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+    } else {
+        MPI_Init(&argc, &argv);
+    }
     int psize, prank;
     MPI_Comm_size(MPI_COMM_WORLD, &psize);
     MPI_Comm_rank(MPI_COMM_WORLD, &prank);
@@ -104,42 +192,161 @@ int main(int argc, char** argv)
     // make sure it is a list for now
     assert(nalu_node.IsSequence());
     const int num_nwsolvers = nalu_node.size();
-    if (num_nwind_ranks < num_nwsolvers) {
-        throw std::runtime_error(
-            "Number of Nalu-Wind ranks is less than the number of Nalu-Wind "
-            "solvers. Please have at least one rank per solver.");
-    }
     std::vector<int> num_nw_solver_ranks;
-    if (node["nalu_wind_procs"]) {
-        num_nw_solver_ranks = node["nalu_wind_procs"].as<std::vector<int>>();
-        if (static_cast<int>(num_nw_solver_ranks.size()) != num_nwsolvers) {
+
+    // Disjoint rank counts balancing the predicted cost per step of the
+    // solvers, which scales with the mesh sizes
+    std::string partition_summary;
+    bool layout_resolved = false;
+    if (node["auto_partition"]) {
+        const YAML::Node& auto_part = node["auto_partition"];
+        const double nalu_element_cost =
+            auto_part["nalu_element_cost"]
+                ? auto_part["nalu_element_cost"].as<double>()
+                : 1.0;
+        const double amr_cell_cost =
+            auto_part["amr_cell_cost"] ? auto_part["amr_cell_cost"].as<double>()
+                                       : 1.0;
+        const double refined_fraction =
+            auto_part["amr_refined_fraction"]
+                ? auto_part["amr_refined_fraction"].as<double>()
+                : 0.1;
+
+        // Only the root rank reads the mesh metadata
+        std::vector<double> costs(num_nwsolvers + 1, 0.0);
+        if (prank == 0) {
+            try {
+                if (use_amr_wind) {
+                    costs[0] =
+                        amr_cell_cost *
+                        exawind::amr_mesh_size(amr_inp, refined_fraction);
+                }
+                for (int i = 0; i < num_nwsolvers; ++i) {
+                    costs[i + 1] =
+                        nalu_element_cost *
+                        exawind::nalu_mesh_size(load_nalu_input(
+                            nalu_node[i], node["nalu_replace_all"]));
+                }
+            } catch (const std::exception& err) {
+                std::cerr << err.what() << std::endl;
+                costs[0] = -1.0;
+            }
+        }
+        MPI_Bcast(
+            costs.data(), static_cast<int>(costs.size()), MPI_DOUBLE, 0,
+            MPI_COMM_WORLD);
+        if (costs[0] < 0.0) {
             throw std::runtime_error(
-                "Number of Nalu-Wind rank specifications is less than the "
-                " number of Nalu-Wind solvers. Please have one rank count "
-                "specification per solver");
+                "Automatic partitioning could not read the mesh sizes");
+        }
+        if (!use_amr_wind) costs.erase(costs.begin());
+
+        const auto ranks = exawind::partition_ranks(costs, psize);
+        const int offset = use_amr_wind ? 1 : 0;
+        num_awind_ranks = use_amr_wind ? ranks[0] : 0;
+        num_nw_solver_ranks.assign(ranks.begin() + offset, ranks.end());
+        num_nwind_ranks = psize - num_awind_ranks;
+
+        std::ostringstream summary;
+        summary << "Automatic partitioning:";
+        if (use_amr_wind) {
+            summary << " AMR-Wind " << num_awind_ranks << " ranks;";
         }
-        const int tot_num_nw_ranks = std::accumulate(
-            num_nw_solver_ranks.begin(), num_nw_solver_ranks.end(), 0);
-        if (tot_num_nw_ranks != num_nwind_ranks) {
+        for (int i = 0; i < num_nwsolvers; ++i) {
+            summary << " Nalu-Wind-" << i + 1 << " " << num_nw_solver_ranks[i]
+                    << " ranks;";
+        }
+        summary << " predicted imbalance "
+                << 100.0 * exawind::predicted_imbalance(costs, ranks) << "%";
+        partition_summary = summary.str();
+        layout_resolved = true;
+    }
+
+    // The rank layout recommended by the autotuner of a previous run takes
+    // precedence, as long as it was measured with the same solvers and ranks
+    const YAML::Node tune_node = node["autotune"];
+    const std::string layout_file =
+        (tune_node && tune_node["layout_file"])
+            ? tune_node["layout_file"].as<std::string>()
+            : "exawind_layout.yaml";
+    if (tune_node && std::ifstream(layout_file).good()) {
+        const YAML::Node layout = YAML::LoadFile(layout_file);
+        const int layout_awind = layout["awind"].as<int>();
+        const auto layout_procs =
+            layout["nalu_wind_procs"].as<std::vector<int>>();
+        const int layout_nwind = layout["nwind"].as<int>();
+        const int layout_ranks = layout["mpi_ranks"].as<int>();
+        const bool consistent =
+            (layout_awind >= 0) &&
+            (layout_awind + layout_nwind == layout_ranks) &&
+            (std::accumulate(layout_procs.begin(), layout_procs.end(), 0) ==
+             layout_nwind) &&
+            std::all_of(
+                layout_procs.begin(), layout_procs.end(),
+                [](const int n) { return n > 0; });
+        if (!consistent) {
             throw std::runtime_error(
-                "Total number of Nalu-Wind ranks does not "
-                "match that given in the command line. Please ensure "
-                "they match");
+                "The autotuned rank layout " + layout_file +
+                " is inconsistent: awind + nwind must equal mpi_ranks and "
+                "nalu_wind_procs must add up to nwind");
         }
-    } else {
-        const int ranks_per_nw_solver = num_nwind_ranks / num_nwsolvers;
-        num_nw_solver_ranks =
-            std::vector<int>(num_nwsolvers, ranks_per_nw_solver);
-        const int remainder = num_nwind_ranks % num_nwsolvers;
-        if (remainder != 0) {
-            std::fill(
-                num_nw_solver_ranks.begin() + num_nwsolvers - remainder,
-                num_nw_solver_ranks.end(), ranks_per_nw_solver + 1);
+        if ((layout_ranks == psize) && ((layout_awind > 0) == use_amr_wind) &&
+            (static_cast<int>(layout_procs.size()) == num_nwsolvers)) {
+            num_awind_ranks = layout_awind;
+            num_nwind_ranks = layout_nwind;
+            num_nw_solver_ranks = layout_procs;
+            partition_summary =
+                "Using the autotuned rank layout " + layout_file;
+            layout_resolved = true;
+        } else {
+            partition_summary = "Ignoring the autotuned rank layout " +
+                                layout_file +
+                                " recorded for a different configuration";
         }
     }
 
-    if (!use_amr_wind) {
-        num_awind_ranks = 0;
+    // The command line and nalu_wind_procs only give the layout when neither
+    // the automatic partitioning nor the autotuner resolved it
+    if (!layout_resolved) {
+        if (num_nwind_ranks < num_nwsolvers) {
+            throw std::runtime_error(
+                "Number of Nalu-Wind ranks is less than the number of "
+                "Nalu-Wind solvers. Please have at least one rank per "
+                "solver.");
+        }
+        if (node["nalu_wind_procs"]) {
+            num_nw_solver_ranks =
+                node["nalu_wind_procs"].as<std::vector<int>>();
+            if (static_cast<int>(num_nw_solver_ranks.size()) !=
+                num_nwsolvers) {
+                throw std::runtime_error(
+                    "Number of Nalu-Wind rank specifications is less than the "
+                    " number of Nalu-Wind solvers. Please have one rank count "
+                    "specification per solver");
+            }
+            const int tot_num_nw_ranks = std::accumulate(
+                num_nw_solver_ranks.begin(), num_nw_solver_ranks.end(), 0);
+            if (tot_num_nw_ranks != num_nwind_ranks) {
+                throw std::runtime_error(
+                    "Total number of Nalu-Wind ranks does not "
+                    "match that given in the command line. Please ensure "
+                    "they match");
+            }
+        } else {
+            const int ranks_per_nw_solver = num_nwind_ranks / num_nwsolvers;
+            num_nw_solver_ranks =
+                std::vector<int>(num_nwsolvers, ranks_per_nw_solver);
+            const int remainder = num_nwind_ranks % num_nwsolvers;
+            if (remainder != 0) {
+                std::fill(
+                    num_nw_solver_ranks.begin() + num_nwsolvers - remainder,
+                    num_nw_solver_ranks.end(), ranks_per_nw_solver + 1);
+            }
+        }
+
+        if (!use_amr_wind) {
+            num_awind_ranks = 0;
+        }
     }
 
     if (num_awind_ranks + num_nwind_ranks < psize) {
@@ -151,159 +358,323 @@ int main(int argc, char** argv)
                 std::to_string(num_awind_ranks + num_nwind_ranks));
     }
 
-    MPI_Comm amr_comm =
-        use_amr_wind
-            ? exawind::create_subcomm(MPI_COMM_WORLD, num_awind_ranks, 0)
-            : MPI_COMM_NULL;
+    // AMR-Wind uses the first ranks and Nalu-Wind the last ones, the
+    // placement policy decides how the Nalu-Wind instances share theirs
+    auto placement = exawind::RankPlacement::Contiguous;
+    const YAML::Node place_node = node["rank_placement"];
+    if (place_node && place_node["policy"]) {
+        placement =
+            exawind::rank_placement(place_node["policy"].as<std::string>());
+    }
+    std::vector<int> amr_ranks;
+    std::vector<std::vector<int>> nalu_ranks;
+    if (placement == exawind::RankPlacement::Explicit) {
+        if (use_amr_wind) {
+            amr_ranks = place_node["amr_wind_ranks"].as<std::vector<int>>();
+        }
+        nalu_ranks = place_node["nalu_wind_ranks"]
+                         .as<std::vector<std::vector<int>>>();
+        bool valid = (static_cast<int>(amr_ranks.size()) == num_awind_ranks) &&
+                     (static_cast<int>(nalu_ranks.size()) == num_nwsolvers);
+        for (int i = 0; valid && (i < num_nwsolvers); ++i) {
+            valid = static_cast<int>(nalu_ranks[i].size()) ==
+                    num_nw_solver_ranks[i];
+        }
+        if (!valid) {
+            throw std::runtime_error(
+                "Explicit rank placement does not match the number of ranks "
+                "of the solvers");
+        }
+        std::vector<bool> used(psize, false);
+        auto use_rank = [&used, psize](const int r) {
+            if ((r < 0) || (r >= psize)) {
+                throw std::runtime_error(
+                    "Explicit rank placement uses rank " + std::to_string(r) +
+                    " outside of the " + std::to_string(psize) +
+                    " MPI ranks");
+            }
+            used[r] = true;
+        };
+        for (const int r : amr_ranks) use_rank(r);
+        for (const auto& nr : nalu_ranks) {
+            for (const int r : nr) use_rank(r);
+        }
+        if (std::find(used.begin(), used.end(), false) != used.end()) {
+            throw std::runtime_error(
+                "Explicit rank placement leaves some MPI ranks unused");
+        }
+    } else {
+        std::vector<int> domains;
+        if (placement != exawind::RankPlacement::Contiguous) {
+            domains = exawind::locality_domains(
+                MPI_COMM_WORLD,
+                placement == exawind::RankPlacement::SocketRoundRobin);
+        }
+        if (use_amr_wind) {
+            amr_ranks =
+                exawind::place_ranks(placement, domains, 0, {num_awind_ranks})
+                    .at(0);
+        }
+        nalu_ranks = exawind::place_ranks(
+            placement, domains, psize - num_nwind_ranks, num_nw_solver_ranks);
+    }
 
-    std::vector<MPI_Comm> nalu_comms;
+    // AMR-Wind and Nalu-Wind may share ranks, so each code splits once
+    MPI_Comm amr_comm =
+        use_amr_wind ? exawind::split_subcomms(MPI_COMM_WORLD, {amr_ranks})[0]
+                     : MPI_COMM_NULL;
+    std::vector<MPI_Comm> nalu_comms =
+        exawind::split_subcomms(MPI_COMM_WORLD, nalu_ranks);
     std::vector<int> nalu_start_rank;
-    int start = psize - num_nwind_ranks;
-    for (const auto& nr : num_nw_solver_ranks) {
-        nalu_start_rank.push_back(start);
-        nalu_comms.push_back(
-            exawind::create_subcomm(MPI_COMM_WORLD, nr, start));
-        start += nr;
+    for (const auto& nr : nalu_ranks) {
+        nalu_start_rank.push_back(*std::min_element(nr.begin(), nr.end()));
     }
 
-    exawind::OversetSimulation sim(MPI_COMM_WORLD);
-    if (amr_comm != MPI_COMM_NULL) {
+    // The simulation holds MPI resources, it has to be gone before
+    // MPI_Finalize
+    {
+        exawind::OversetSimulation sim(MPI_COMM_WORLD);
+        if (!partition_summary.empty()) sim.echo(partition_summary);
+        if (amr_comm != MPI_COMM_NULL) {
+            sim.echo(
+                "Initializing AMR-Wind on " + std::to_string(num_awind_ranks) +
+                " MPI ranks");
+            out.open(amr_log);
+            exawind::AMRWind::initialize(amr_comm, amr_inp, out);
+        }
         sim.echo(
-            "Initializing AMR-Wind on " + std::to_string(num_awind_ranks) +
-            " MPI ranks");
-        out.open(amr_log);
-        exawind::AMRWind::initialize(amr_comm, amr_inp, out);
-    }
-    sim.echo(
-        "Initializing " + std::to_string(num_nwsolvers) +
-        " Nalu-Wind solvers, equally partitioned on a total of " +
-        std::to_string(num_nwind_ranks) + " MPI ranks");
-    if (std::any_of(nalu_comms.begin(), nalu_comms.end(), [](const auto& comm) {
-            return comm != MPI_COMM_NULL;
-        })) {
-        exawind::NaluWind::initialize();
-    }
-    sim.set_nw_start_rank(nalu_start_rank);
-
-    const auto nalu_vars = node["nalu_vars"].as<std::vector<std::string>>();
-    const int num_timesteps =
-        node["num_timesteps"] ? node["num_timesteps"].as<int>() : -1;
-    const double max_time =
-        node["max_time"] ? node["max_time"].as<double>() : -1.0;
-    const int additional_picard_its =
-        node["additional_picard_iterations"]
-            ? node["additional_picard_iterations"].as<int>()
-            : 0;
-    const int nonlinear_its = node["nonlinear_iterations"]
-                                  ? node["nonlinear_iterations"].as<int>()
-                                  : 1;
-    const bool holemap_alg = node["use_adaptive_holemap"]
-                                 ? node["use_adaptive_holemap"].as<bool>()
-                                 : false;
-    sim.set_holemap_alg(holemap_alg);
-
-    if (num_timesteps < 0 && max_time < 0.) {
-        throw std::runtime_error(
-            "max_timesteps or num_timesteps must be specified as positive "
-            "values. These are both unspecified or specified as negative.");
-    }
+            "Initializing " + std::to_string(num_nwsolvers) +
+            " Nalu-Wind solvers, equally partitioned on a total of " +
+            std::to_string(num_nwind_ranks) + " MPI ranks");
+        if (std::any_of(
+                nalu_comms.begin(), nalu_comms.end(),
+                [](const auto& comm) { return comm != MPI_COMM_NULL; })) {
+            exawind::NaluWind::initialize();
+        }
+        sim.set_nw_start_rank(nalu_start_rank);
+
+        const auto nalu_vars =
+            node["nalu_vars"].as<std::vector<std::string>>();
+        const int num_timesteps =
+            node["num_timesteps"] ? node["num_timesteps"].as<int>() : -1;
+        const double max_time =
+            node["max_time"] ? node["max_time"].as<double>() : -1.0;
+        const int additional_picard_its =
+            iteration_count(node, "additional_picard_iterations", 0, 0);
+        const int nonlinear_its =
+            iteration_count(node, "nonlinear_iterations", 1, 1);
+        const bool holemap_alg = node["use_adaptive_holemap"]
+                                     ? node["use_adaptive_holemap"].as<bool>()
+                                     : false;
+        sim.set_holemap_alg(holemap_alg);
+        if (node["coupling_mode"]) {
+            sim.set_coupling_mode(node["coupling_mode"].as<std::string>());
+        }
+        if (node["nalu_substeps"]) {
+            sim.set_num_substeps(node["nalu_substeps"].as<int>());
+        }
+        if (node["fringe_extrapolation"]) {
+            const YAML::Node& extrap = node["fringe_extrapolation"];
+            const int order = extrap["order"] ? extrap["order"].as<int>() : 1;
+            const int exchange_interval =
+                extrap["exchange_interval"]
+                    ? extrap["exchange_interval"].as<int>()
+                    : 2;
+            const double tolerance =
+                extrap["drift_tolerance"]
+                    ? extrap["drift_tolerance"].as<double>()
+                    : 1.0e-2;
+            sim.set_fringe_extrapolation(order, exchange_interval, tolerance);
+        }
+        if (node["adaptive_iterations"]) {
+            const YAML::Node& adapt = node["adaptive_iterations"];
+            const double fringe_tol =
+                adapt["fringe_tolerance"]
+                    ? adapt["fringe_tolerance"].as<double>()
+                    : 1.0e-3;
+            // Residual levels depend on the solver settings, there is no
+            // default that fits all cases
+            if (!adapt["residual_tolerance"]) {
+                throw std::runtime_error(
+                    "adaptive_iterations requires a residual_tolerance");
+            }
+            const double residual_tol =
+                adapt["residual_tolerance"].as<double>();
+            sim.set_adaptive_iterations(fringe_tol, residual_tol);
+        }
+        if (node["motion_triggered_connectivity"]) {
+            const YAML::Node& trigger = node["motion_triggered_connectivity"];
+            const double threshold =
+                trigger["motion_fraction"]
+                    ? trigger["motion_fraction"].as<double>()
+                    : 0.25;
+            const int max_interval = trigger["max_interval"]
+                                         ? trigger["max_interval"].as<int>()
+                                         : 10;
+            sim.set_motion_triggered_connectivity(threshold, max_interval);
+        }
+        if (node["incremental_connectivity"]) {
+            sim.set_incremental_connectivity(
+                node["incremental_connectivity"].as<bool>());
+        }
+        if (node["lookahead_connectivity"]) {
+            sim.set_lookahead_connectivity(
+                node["lookahead_connectivity"].as<bool>());
+        }
+        if (node["exchange_schedule"]) {
+            // TIOGA matches the exchanged components by position, a field is
+            // scheduled with the fields of the other solvers at its position
+            std::vector<std::vector<std::string>> field_lists{nalu_vars};
+            if (use_amr_wind) {
+                auto amr_vars =
+                    node["amr_cell_vars"].as<std::vector<std::string>>();
+                const auto amr_nvars =
+                    node["amr_node_vars"].as<std::vector<std::string>>();
+                amr_vars.insert(
+                    amr_vars.end(), amr_nvars.begin(), amr_nvars.end());
+                field_lists.push_back(amr_vars);
+            }
+            for (const auto& sched : node["exchange_schedule"]) {
+                const auto field = sched.first.as<std::string>();
+                sim.set_exchange_schedule(
+                    exchange_position(field, field_lists), field,
+                    sched.second.as<std::string>());
+            }
+        }
+        if (node["overlap_exchange"]) {
+            sim.set_overlap_exchange(node["overlap_exchange"].as<bool>());
+        }
+        if (tune_node) {
+            const int window =
+                tune_node["window"] ? tune_node["window"].as<int>() : 10;
+            const int warmup_steps = tune_node["warmup_steps"]
+                                         ? tune_node["warmup_steps"].as<int>()
+                                         : 1;
+            const bool stop_after_window =
+                tune_node["stop_after_window"]
+                    ? tune_node["stop_after_window"].as<bool>()
+                    : false;
+            sim.set_autotune(
+                window, warmup_steps, layout_file, stop_after_window);
+        }
+        if (node["timing_output_interval"]) {
+            sim.set_report_interval(node["timing_output_interval"].as<int>());
+        }
 
-    if (node["composite_body"]) {
-        const YAML::Node& composite_mesh = node["composite_body"];
-        const int num_composite = static_cast<int>(composite_mesh.size());
-        sim.set_composite_num(num_composite);
+        if (num_timesteps < 0 && max_time < 0.) {
+            throw std::runtime_error(
+                "max_timesteps or num_timesteps must be specified as positive "
+                "values. These are both unspecified or specified as negative.");
+        }
+
+        if (node["composite_body"]) {
+            const YAML::Node& composite_mesh = node["composite_body"];
+            const int num_composite = static_cast<int>(composite_mesh.size());
+            sim.set_composite_num(num_composite);
 
-        for (int i = 0; i < num_composite; i++) {
-            const YAML::Node& composite_node = composite_mesh[i];
+            for (int i = 0; i < num_composite; i++) {
+                const YAML::Node& composite_node = composite_mesh[i];
 
-            const int num_body_tags = composite_node["num_body_tags"].as<int>();
+                const int num_body_tags =
+                    composite_node["num_body_tags"].as<int>();
 
-            const auto body_tags =
-                composite_node["body_tags"].as<std::vector<int>>();
+                const auto body_tags =
+                    composite_node["body_tags"].as<std::vector<int>>();
 
-            const auto dominance_tags =
-                composite_node["dominance_tags"].as<std::vector<int>>();
+                const auto dominance_tags =
+                    composite_node["dominance_tags"].as<std::vector<int>>();
 
-            const double search_tol =
-                composite_node["search_tolerance"].as<double>();
+                const double search_tol =
+                    composite_node["search_tolerance"].as<double>();
 
-            sim.set_composite_body(
-                i, num_body_tags, body_tags, dominance_tags, search_tol);
+                sim.set_composite_body(
+                    i, num_body_tags, body_tags, dominance_tags, search_tol);
+            }
         }
-    }
 
-    const YAML::Node yaml_replace_all = node["nalu_replace_all"];
-    for (int i = 0; i < num_nwsolvers; i++) {
-        if (nalu_comms.at(i) != MPI_COMM_NULL) {
-            YAML::Node yaml_replace_instance;
-            YAML::Node this_instance = nalu_node[i];
-
-            std::string nalu_inpfile, logfile;
-            bool write_final_yaml_to_disk = false;
-            if (this_instance.IsMap()) {
-                yaml_replace_instance = this_instance["replace"];
-                nalu_inpfile =
-                    this_instance["base_input_file"].as<std::string>();
-                // deal with the logfile name
-                if (this_instance["logfile"]) {
-                    logfile = this_instance["logfile"].as<std::string>();
+        const YAML::Node yaml_replace_all = node["nalu_replace_all"];
+        for (int i = 0; i < num_nwsolvers; i++) {
+            if (nalu_comms.at(i) != MPI_COMM_NULL) {
+                YAML::Node this_instance = nalu_node[i];
+
+                std::string nalu_inpfile, logfile;
+                bool write_final_yaml_to_disk = false;
+                int instance_nonlinear_its = -1;
+                int instance_picard_its = -1;
+                if (this_instance.IsMap()) {
+                    nalu_inpfile =
+                        this_instance["base_input_file"].as<std::string>();
+                    // deal with the logfile name
+                    if (this_instance["logfile"]) {
+                        logfile = this_instance["logfile"].as<std::string>();
+                    } else {
+                        logfile = exawind::NaluWind::change_file_name_suffix(
+                            nalu_inpfile, ".log", i);
+                    }
+                    if (this_instance["write_final_yaml_to_disk"]) {
+                        write_final_yaml_to_disk =
+                            this_instance["write_final_yaml_to_disk"]
+                                .as<bool>();
+                    }
+                    instance_nonlinear_its = iteration_count(
+                        this_instance, "nonlinear_iterations", -1, 1);
+                    instance_picard_its = iteration_count(
+                        this_instance, "additional_picard_iterations", -1, 0);
+
                 } else {
+                    nalu_inpfile = this_instance.as<std::string>();
                     logfile = exawind::NaluWind::change_file_name_suffix(
-                        nalu_inpfile, ".log", i);
-                }
-                if (this_instance["write_final_yaml_to_disk"]) {
-                    write_final_yaml_to_disk =
-                        this_instance["write_final_yaml_to_disk"].as<bool>();
+                        nalu_inpfile, ".log");
                 }
 
-            } else {
-                nalu_inpfile = this_instance.as<std::string>();
-                logfile = exawind::NaluWind::change_file_name_suffix(
-                    nalu_inpfile, ".log");
-            }
+                YAML::Node nalu_yaml =
+                    load_nalu_input(this_instance, yaml_replace_all);
+
+                // only the first rank of the comm should write the file
+                int comm_rank = -1;
+                MPI_Comm_rank(nalu_comms.at(i), &comm_rank);
+                if (write_final_yaml_to_disk && comm_rank == 0) {
+                    auto new_ifile_name =
+                        exawind::NaluWind::change_file_name_suffix(
+                            logfile, ".yaml");
+                    std::ofstream fout(new_ifile_name);
+                    fout << nalu_yaml;
+                    fout.close();
+                }
 
-            YAML::Node nalu_yaml = YAML::LoadFile(nalu_inpfile);
-            // replace in order so instance can overwrite all
-            if (yaml_replace_all) {
-                YEDIT::find_and_replace(nalu_yaml, yaml_replace_all);
-            }
-            if (yaml_replace_instance) {
-                YEDIT::find_and_replace(nalu_yaml, yaml_replace_instance);
+                auto& nw = sim.register_solver<exawind::NaluWind>(
+                    i + 1, nalu_comms.at(i), nalu_yaml, logfile, nalu_vars);
+                nw.set_iteration_budget(
+                    instance_nonlinear_its, instance_picard_its);
             }
+        }
 
-            // only the first rank of the comm should write the file
-            int comm_rank = -1;
-            MPI_Comm_rank(nalu_comms.at(i), &comm_rank);
-            if (write_final_yaml_to_disk && comm_rank == 0) {
-                auto new_ifile_name =
-                    exawind::NaluWind::change_file_name_suffix(
-                        logfile, ".yaml");
-                std::ofstream fout(new_ifile_name);
-                fout << nalu_yaml;
-                fout.close();
+        if (amr_comm != MPI_COMM_NULL) {
+            const auto amr_cvars =
+                node["amr_cell_vars"].as<std::vector<std::string>>();
+            const auto amr_nvars =
+                node["amr_node_vars"].as<std::vector<std::string>>();
+
+            auto& aw =
+                sim.register_solver<exawind::AMRWind>(amr_cvars, amr_nvars);
+            if (node["amr_wind_overlap_stage2"]) {
+                aw.set_overlap_stage2(
+                    node["amr_wind_overlap_stage2"].as<bool>());
             }
-
-            sim.register_solver<exawind::NaluWind>(
-                i + 1, nalu_comms.at(i), nalu_yaml, logfile, nalu_vars);
+            aw.set_iteration_budget(
+                iteration_count(node, "amr_wind_nonlinear_iterations", -1, 1),
+                iteration_count(
+                    node, "amr_wind_additional_picard_iterations", -1, 0));
         }
-    }
 
-    if (amr_comm != MPI_COMM_NULL) {
-        const auto amr_cvars =
-            node["amr_cell_vars"].as<std::vector<std::string>>();
-        const auto amr_nvars =
-            node["amr_node_vars"].as<std::vector<std::string>>();
-
-        sim.register_solver<exawind::AMRWind>(amr_cvars, amr_nvars);
+        sim.echo("Initializing overset simulation");
+        sim.initialize();
+        sim.echo("Initialization successful");
+        sim.run_timesteps(
+            additional_picard_its, nonlinear_its, num_timesteps, max_time);
+        sim.delete_solvers();
     }
 
-    sim.echo("Initializing overset simulation");
-    sim.initialize();
-    sim.echo("Initialization successful");
-    sim.run_timesteps(
-        additional_picard_its, nonlinear_its, num_timesteps, max_time);
-    sim.delete_solvers();
-
     if (amr_comm != MPI_COMM_NULL) {
         exawind::AMRWind::finalize();
         out.close();
@@ -1,8 +1,12 @@
+#include <algorithm>
+#include <functional>
 #include <vector>
 
 #include "AMRTiogaIface.h"
 #include "amr-wind/CFDSim.H"
 #include "amr-wind/overset/TiogaInterface.H"
+#include "AMReX_GpuContainers.H"
+#include "AMReX_iMultiFab.H"
 #include "TiogaMeshInfo.h"
 #include "tioga.h"
 
@@ -10,29 +14,175 @@ namespace exawind {
 
 namespace {
 
+//! Point the TIOGA array descriptor to the AMR-Wind view, returns true if
+//! the descriptor has changed
 template <typename T1, typename T2>
-void amr_to_tioga(T1& lhs, T2& rhs)
+bool amr_to_tioga(T1& lhs, T2& rhs)
 {
+    const bool changed = (lhs.sz != rhs.size()) ||
+                         (lhs.hptr != rhs.h_view.data()) ||
+                         (lhs.dptr != rhs.d_view.data());
     lhs.sz = rhs.size();
     lhs.hptr = rhs.h_view.data();
     lhs.dptr = rhs.d_view.data();
+    return changed;
+}
+
+//! Keep a copy of the host contents of the AMR-Wind view, returns true if
+//! they differ from the previous copy
+template <typename T>
+bool update_copy(T& view, std::vector<char>& copy)
+{
+    const auto* ptr = reinterpret_cast<const char*>(view.h_view.data());
+    const size_t nbytes = view.size() * sizeof(*view.h_view.data());
+    if ((copy.size() == nbytes) && std::equal(ptr, ptr + nbytes, copy.begin()))
+        return false;
+    copy.assign(ptr, ptr + nbytes);
+    return true;
+}
+
+//! Point the TIOGA array descriptor to host and device pointer arrays,
+//! returns true if the descriptor has changed
+template <typename T>
+bool ptrs_to_tioga(
+    T& lhs,
+    amrex::Vector<int*>& hptrs,
+    amrex::Gpu::DeviceVector<int*>& dptrs)
+{
+    const bool changed = (lhs.sz != hptrs.size()) ||
+                         (lhs.hptr != hptrs.data()) ||
+                         (lhs.dptr != dptrs.data());
+    lhs.sz = hptrs.size();
+    lhs.hptr = hptrs.data();
+    lhs.dptr = dptrs.data();
+    return changed;
 }
 
 } // namespace
 
+//! Copy of an iblank field and the pointers to the data of its grids, in the
+//! order in which AMR-Wind registers the grids with TIOGA
+struct AMRTiogaIface::IblankCopy
+{
+    amrex::Vector<amrex::iMultiFab> mfs;
+    amrex::Vector<int*> hptrs;
+    amrex::Gpu::DeviceVector<int*> dptrs;
+
+    //! Match the layout of the iblank field and reset the copy to unblanked
+    void setup(amr_wind::IntField& iblank, const int nlevels)
+    {
+        mfs.resize(nlevels);
+        hptrs.clear();
+        for (int lev = 0; lev < nlevels; ++lev) {
+            const auto& mf = iblank(lev);
+            if ((mfs[lev].boxArray() != mf.boxArray()) ||
+                (mfs[lev].DistributionMap() != mf.DistributionMap())) {
+                mfs[lev].define(
+                    mf.boxArray(), mf.DistributionMap(), 1, mf.nGrowVect());
+            }
+            mfs[lev].setVal(1);
+            for (amrex::MFIter mfi(mfs[lev]); mfi.isValid(); ++mfi) {
+                hptrs.push_back(mfs[lev][mfi].dataPtr());
+            }
+        }
+        // The storage is kept while the grids do not change, so is the TIOGA
+        // registration
+        dptrs.resize(hptrs.size());
+        amrex::Gpu::copy(
+            amrex::Gpu::hostToDevice, hptrs.begin(), hptrs.end(),
+            dptrs.begin());
+    }
+
+    //! Overwrite the iblank field with the copy
+    void restore(amr_wind::IntField& iblank) const
+    {
+        for (int lev = 0; lev < static_cast<int>(mfs.size()); ++lev) {
+            auto& mf = iblank(lev);
+            amrex::iMultiFab::Copy(mf, mfs[lev], 0, 0, 1, mf.nGrowVect());
+        }
+    }
+};
+
 AMRTiogaIface::AMRTiogaIface(amr_wind::CFDSim& sim, TIOGA::tioga& tg)
     : m_sim(sim), m_tg(tg), m_info(new TIOGA::AMRMeshInfo)
 {}
 
+AMRTiogaIface::~AMRTiogaIface() = default;
+
 void AMRTiogaIface::pre_overset_conn_work()
 {
     m_sim.overset_manager()->pre_overset_conn_work();
+    m_use_iblank_copy = false;
+    register_mesh();
+}
+
+void AMRTiogaIface::register_mesh_copy()
+{
+    // The AMR-Wind iblank fields are left alone, it keeps using them until
+    // the connectivity is done
+    if (!m_iblank_cell_copy) {
+        m_iblank_cell_copy.reset(new IblankCopy);
+        m_iblank_node_copy.reset(new IblankCopy);
+    }
+    auto& repo = m_sim.repo();
+    const int nlevels = repo.num_active_levels();
+    m_iblank_cell_copy->setup(repo.get_int_field("iblank_cell"), nlevels);
+    m_iblank_node_copy->setup(repo.get_int_field("iblank_node"), nlevels);
+    m_use_iblank_copy = true;
     register_mesh();
 }
 
 void AMRTiogaIface::post_overset_conn_work()
 {
+    if (m_use_iblank_copy) {
+        auto& repo = m_sim.repo();
+        m_iblank_cell_copy->restore(repo.get_int_field("iblank_cell"));
+        m_iblank_node_copy->restore(repo.get_int_field("iblank_node"));
+    }
     m_sim.overset_manager()->post_overset_conn_work();
+    m_grid_registered = false;
+}
+
+amr_wind::TiogaInterface& AMRTiogaIface::amr_iface()
+{
+    if (m_amr_iface == nullptr) {
+        m_amr_iface =
+            dynamic_cast<amr_wind::TiogaInterface*>(m_sim.overset_manager());
+        if (m_amr_iface == nullptr) {
+            amrex::Abort("Dynamic cast to TiogaInterface failed");
+        }
+    }
+    return *m_amr_iface;
+}
+
+std::size_t AMRTiogaIface::grid_fingerprint() const
+{
+    // The box arrays and distribution maps are replicated on all ranks, so
+    // the fingerprint is the same everywhere
+    const auto& mesh = m_sim.mesh();
+    std::size_t seed = 0;
+    auto combine = [&seed](const long val) {
+        seed ^= std::hash<long>{}(val) + 0x9e3779b97f4a7c15ULL + (seed << 6) +
+                (seed >> 2);
+    };
+
+    const int finest_level = mesh.finestLevel();
+    combine(finest_level);
+    for (int lev = 0; lev <= finest_level; ++lev) {
+        const auto& ba = mesh.boxArray(lev);
+        combine(ba.size());
+        for (int i = 0; i < static_cast<int>(ba.size()); ++i) {
+            const amrex::Box bx = ba[i];
+            for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                combine(bx.smallEnd(d));
+                combine(bx.bigEnd(d));
+            }
+        }
+        for (const int proc : mesh.DistributionMap(lev).ProcessorMap()) {
+            combine(proc);
+        }
+    }
+    return seed;
 }
 
 void AMRTiogaIface::register_mesh()
@@ -40,29 +190,42 @@ void AMRTiogaIface::register_mesh()
     BL_PROFILE("exawind::AMRTiogaIface::register_mesh");
     const int num_ghost = m_sim.pde_manager().num_ghost_state();
 
-    auto* amr_tg_iface =
-        dynamic_cast<amr_wind::TiogaInterface*>(m_sim.overset_manager());
-    if (amr_tg_iface == nullptr) {
-        amrex::Abort("Dynamic cast to TiogaInterface failed");
-        return;
-    }
-    auto& ad = amr_tg_iface->amr_overset_info();
+    auto& ad = amr_iface().amr_overset_info();
     auto& mi = *m_info;
 
+    // The views keep their storage unless the grids change, in which case
+    // the grid is registered again and TIOGA preprocesses it
+    const std::size_t fingerprint = grid_fingerprint();
+    bool changed = !m_has_registration ||
+                   (fingerprint != m_registered_fingerprint) ||
+                   (mi.ngrids_global != ad.ngrids_global) ||
+                   (mi.ngrids_local != ad.ngrids_local) ||
+                   (mi.num_ghost != num_ghost);
     mi.ngrids_global = ad.ngrids_global;
     mi.ngrids_local = ad.ngrids_local;
     mi.num_ghost = num_ghost;
-    amr_to_tioga(mi.level, ad.level);
-    amr_to_tioga(mi.mpi_rank, ad.mpi_rank);
-    amr_to_tioga(mi.local_id, ad.local_id);
-    amr_to_tioga(mi.ilow, ad.ilow);
-    amr_to_tioga(mi.ihigh, ad.ihigh);
-    amr_to_tioga(mi.dims, ad.dims);
-    amr_to_tioga(mi.xlo, ad.xlo);
-    amr_to_tioga(mi.dx, ad.dx);
-    amr_to_tioga(mi.global_idmap, ad.global_idmap);
-    amr_to_tioga(mi.iblank_node, ad.iblank_node);
-    amr_to_tioga(mi.iblank_cell, ad.iblank_cell);
+    changed |= amr_to_tioga(mi.level, ad.level);
+    changed |= amr_to_tioga(mi.mpi_rank, ad.mpi_rank);
+    changed |= amr_to_tioga(mi.local_id, ad.local_id);
+    changed |= amr_to_tioga(mi.ilow, ad.ilow);
+    changed |= amr_to_tioga(mi.ihigh, ad.ihigh);
+    changed |= amr_to_tioga(mi.dims, ad.dims);
+    changed |= amr_to_tioga(mi.xlo, ad.xlo);
+    changed |= amr_to_tioga(mi.dx, ad.dx);
+    changed |= amr_to_tioga(mi.global_idmap, ad.global_idmap);
+    if (m_use_iblank_copy) {
+        changed |= ptrs_to_tioga(
+            mi.iblank_node, m_iblank_node_copy->hptrs,
+            m_iblank_node_copy->dptrs);
+        changed |= ptrs_to_tioga(
+            mi.iblank_cell, m_iblank_cell_copy->hptrs,
+            m_iblank_cell_copy->dptrs);
+    } else {
+        changed |= amr_to_tioga(mi.iblank_node, ad.iblank_node);
+        changed |= amr_to_tioga(mi.iblank_cell, ad.iblank_cell);
+    }
+    if (!changed) return;
+
     amr_to_tioga(mi.qcell, ad.qcell);
     amr_to_tioga(mi.qnode, ad.qnode);
 
@@ -71,32 +234,36 @@ void AMRTiogaIface::register_mesh()
     mi.nvar_node = 0;
 
     m_tg.register_amr_grid(m_info.get());
+    m_registered_fingerprint = fingerprint;
+    m_has_registration = true;
+    m_grid_registered = true;
 }
 
 void AMRTiogaIface::register_solution(
     const std::vector<std::string>& cell_vars,
     const std::vector<std::string>& node_vars)
 {
-    auto* amr_tg_iface =
-        dynamic_cast<amr_wind::TiogaInterface*>(m_sim.overset_manager());
-    if (amr_tg_iface == nullptr) {
-        amrex::Abort("Dynamic cast to TiogaInterface failed");
-        return;
-    }
-    amr_tg_iface->register_solution(cell_vars, node_vars);
-    auto& qcell = amr_tg_iface->qvars_cell();
-    auto& qnode = amr_tg_iface->qvars_node();
+    auto& amr_tg_iface = amr_iface();
+    amr_tg_iface.register_solution(cell_vars, node_vars);
+    auto& qcell = amr_tg_iface.qvars_cell();
+    auto& qnode = amr_tg_iface.qvars_node();
 
     // Ensure that ghost cells are consistent
     AMREX_ALWAYS_ASSERT(qcell.num_grow()[0] == qnode.num_grow()[0]);
 
-    auto& ad = amr_tg_iface->amr_overset_info();
+    // The values are packed by AMR-Wind above. TIOGA only needs the layout
+    // again if the number of variables or the solution arrays have changed.
+    auto& ad = amr_tg_iface.amr_overset_info();
     auto& mi = *m_info;
+    bool changed = (mi.nvar_cell != qcell.num_comp()) ||
+                   (mi.nvar_node != qnode.num_comp());
     mi.nvar_cell = qcell.num_comp();
     mi.nvar_node = qnode.num_comp();
-    amr_to_tioga(mi.qcell, ad.qcell);
-    amr_to_tioga(mi.qnode, ad.qnode);
-    m_tg.register_amr_solution();
+    changed |= amr_to_tioga(mi.qcell, ad.qcell);
+    changed |= amr_to_tioga(mi.qnode, ad.qnode);
+    changed |= update_copy(ad.qcell, m_qcell_ptrs);
+    changed |= update_copy(ad.qnode, m_qnode_ptrs);
+    if (changed) m_tg.register_amr_solution();
 }
 
 void AMRTiogaIface::update_solution()
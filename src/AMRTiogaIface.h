@@ -1,12 +1,15 @@
 #ifndef AMRTIOGAIFACE_H
 #define AMRTIOGAIFACE_H
 
+#include <cstddef>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace amr_wind {
 class CFDSim;
-}
+class TiogaInterface;
+} // namespace amr_wind
 
 namespace TIOGA {
 class tioga;
@@ -19,9 +22,16 @@ class AMRTiogaIface
 {
 public:
     AMRTiogaIface(amr_wind::CFDSim&, TIOGA::tioga& tg);
+    ~AMRTiogaIface();
 
     void pre_overset_conn_work();
 
+    //! Register the grid with copies of the iblank fields, so that TIOGA can
+    //! compute a connectivity while AMR-Wind keeps using its own. The copies
+    //! replace the iblank fields in post_overset_conn_work. The grid must be
+    //! the one of the last pre_overset_conn_work.
+    void register_mesh_copy();
+
     void post_overset_conn_work();
 
     void register_mesh();
@@ -32,11 +42,37 @@ public:
 
     void update_solution();
 
+    //! Hash of the levels, box arrays and distribution maps of the grids
+    std::size_t grid_fingerprint() const;
+
+    //! True if the grid was registered with TIOGA since the last
+    //! connectivity update and needs to be preprocessed
+    bool grid_registered() const { return m_grid_registered; }
+
 private:
+    struct IblankCopy;
+
+    //! AMR-Wind overset interface, resolved on first use
+    amr_wind::TiogaInterface& amr_iface();
+
     amr_wind::CFDSim& m_sim;
     TIOGA::tioga& m_tg;
 
     std::unique_ptr<TIOGA::AMRMeshInfo> m_info;
+
+    amr_wind::TiogaInterface* m_amr_iface{nullptr};
+    //! Fingerprint of the grid registered with TIOGA
+    std::size_t m_registered_fingerprint{0};
+    bool m_has_registration{false};
+    bool m_grid_registered{false};
+    //! Solution array pointers registered with TIOGA
+    std::vector<char> m_qcell_ptrs;
+    std::vector<char> m_qnode_ptrs;
+    //! Copies of the iblank fields and flag indicating whether they are
+    //! registered with TIOGA in place of the AMR-Wind ones
+    std::unique_ptr<IblankCopy> m_iblank_cell_copy;
+    std::unique_ptr<IblankCopy> m_iblank_node_copy;
+    bool m_use_iblank_copy{false};
 };
 
 } // namespace exawind
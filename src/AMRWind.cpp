@@ -2,8 +2,11 @@
 #include "amr-wind/incflo.H"
 #include "amr-wind/CFDSim.H"
 #include "amr-wind/core/SimTime.H"
+#include "amr-wind/core/FieldRepo.H"
 #include "amr-wind/utilities/console_io.H"
 #include "AMReX.H"
+#include "AMReX_Loop.H"
+#include "AMReX_MFIter.H"
 #include "AMReX_ParmParse.H"
 
 #include "tioga.h"
@@ -48,6 +51,8 @@ AMRWind::AMRWind(
     , m_tgiface(m_incflo.sim(), tg)
     , m_cell_vars(cell_vars)
     , m_node_vars(node_vars)
+    , m_exchange_cell_vars(cell_vars)
+    , m_exchange_node_vars(node_vars)
     , m_comm(amrex::ParallelContext::CommunicatorSub())
 {
     m_incflo.sim().activate_overset();
@@ -111,14 +116,176 @@ void AMRWind::post_advance() { m_incflo.post_advance_work(); }
 
 void AMRWind::pre_overset_conn_work() { m_tgiface.pre_overset_conn_work(); }
 
-void AMRWind::post_overset_conn_work() { m_tgiface.post_overset_conn_work(); }
+void AMRWind::post_overset_conn_work()
+{
+    m_tgiface.post_overset_conn_work();
+    m_conn_fingerprint = m_tgiface.grid_fingerprint();
+    m_has_conn = true;
+}
+
+void AMRWind::predict_overset_mesh(const double /*time*/)
+{
+    // The grid does not change without regridding. TIOGA fills copies of the
+    // iblank fields, the solver keeps using its own until the connectivity
+    // is done.
+    m_tgiface.register_mesh_copy();
+}
+
+std::vector<std::string> AMRWind::exchange_fields()
+{
+    auto fields = m_cell_vars;
+    fields.insert(fields.end(), m_node_vars.begin(), m_node_vars.end());
+    return fields;
+}
+
+void AMRWind::select_exchange_fields(
+    const ExchangeSchedule& schedule, const bool first, const bool last)
+{
+    // The node fields follow the cell fields in the exchanged field list
+    const int ncell = static_cast<int>(m_cell_vars.size());
+    m_exchange_cell_vars.clear();
+    m_exchange_node_vars.clear();
+    for (int i = 0; i < ncell; ++i) {
+        if (schedule.due(i, first, last)) {
+            m_exchange_cell_vars.push_back(m_cell_vars[i]);
+        }
+    }
+    for (size_t i = 0; i < m_node_vars.size(); ++i) {
+        if (schedule.due(ncell + static_cast<int>(i), first, last)) {
+            m_exchange_node_vars.push_back(m_node_vars[i]);
+        }
+    }
+}
 
 void AMRWind::register_solution()
 {
-    m_tgiface.register_solution(m_cell_vars, m_node_vars);
+    if (m_exchange_time_fraction >= 1.0) {
+        m_tgiface.register_solution(m_exchange_cell_vars, m_exchange_node_vars);
+        return;
+    }
+
+    // Register the solution interpolated between the old and new states. The
+    // new states are overwritten for the registration and restored after.
+    auto& repo = m_incflo.sim().repo();
+    const int nlevels = repo.num_active_levels();
+    const double frac = m_exchange_time_fraction;
+    std::vector<amrex::Vector<amrex::MultiFab>> saved;
+    std::vector<amr_wind::Field*> fields;
+    std::vector<std::string> end_values(m_exchange_node_vars);
+    for (const auto& name : m_exchange_cell_vars) {
+        auto& fld = repo.get_field(name);
+        if (fld.num_time_states() < 2) {
+            end_values.push_back(name);
+            continue;
+        }
+        auto& fld_old = fld.state(amr_wind::FieldState::Old);
+        const int ncomp = fld.num_comp();
+        amrex::Vector<amrex::MultiFab> fld_saved(nlevels);
+        for (int lev = 0; lev < nlevels; ++lev) {
+            auto& mf = fld(lev);
+            const auto ngrow = mf.nGrowVect();
+            fld_saved[lev].define(
+                mf.boxArray(), mf.DistributionMap(), ncomp, ngrow);
+            amrex::MultiFab::Copy(fld_saved[lev], mf, 0, 0, ncomp, ngrow);
+            amrex::MultiFab::LinComb(
+                mf, 1.0 - frac, fld_old(lev), 0, frac, mf, 0, 0, ncomp, ngrow);
+        }
+        fields.push_back(&fld);
+        saved.push_back(std::move(fld_saved));
+    }
+    if (!end_values.empty() && !m_reported_end_values) {
+        m_reported_end_values = true;
+        amrex::Print() << "Fields exchanged at their end of step values "
+                          "during sub-steps:";
+        for (const auto& name : end_values) amrex::Print() << " " << name;
+        amrex::Print() << std::endl;
+    }
+
+    m_tgiface.register_solution(m_exchange_cell_vars, m_exchange_node_vars);
+
+    for (size_t i = 0; i < fields.size(); ++i) {
+        auto& fld = *fields[i];
+        const int ncomp = fld.num_comp();
+        for (int lev = 0; lev < nlevels; ++lev) {
+            auto& mf = fld(lev);
+            amrex::MultiFab::Copy(
+                mf, saved[i][lev], 0, 0, ncomp, mf.nGrowVect());
+        }
+    }
+}
+
+void AMRWind::update_solution()
+{
+    // While the background is ahead of the exchange time its fringe data is
+    // not needed, it is updated by the next full exchange
+    if (m_exchange_time_fraction < 1.0) return;
+    m_tgiface.update_solution();
 }
 
-void AMRWind::update_solution() { m_tgiface.update_solution(); }
+template <typename Visitor>
+void AMRWind::visit_fringe_values(const bool modify, Visitor&& visit)
+{
+    amrex::ignore_unused(modify);
+    auto& repo = m_incflo.sim().repo();
+    const int nlevels = repo.num_active_levels();
+    const std::vector<std::pair<const std::vector<std::string>*, std::string>>
+        groups{{&m_cell_vars, "iblank_cell"}, {&m_node_vars, "iblank_node"}};
+
+    for (const auto& grp : groups) {
+        auto& iblank = repo.get_int_field(grp.second);
+        for (const auto& name : *grp.first) {
+            auto& fld = repo.get_field(name);
+            const int ncomp = fld.num_comp();
+            for (int lev = 0; lev < nlevels; ++lev) {
+                for (amrex::MFIter mfi(fld(lev)); mfi.isValid(); ++mfi) {
+                    auto& fab = fld(lev)[mfi];
+                    const auto& ifab = iblank(lev)[mfi];
+                    const amrex::Box bx = fab.box() & ifab.box();
+#ifdef AMREX_USE_GPU
+                    amrex::FArrayBox hfab(
+                        fab.box(), ncomp, amrex::The_Pinned_Arena());
+                    amrex::IArrayBox hifab(
+                        ifab.box(), 1, amrex::The_Pinned_Arena());
+                    amrex::Gpu::dtoh_memcpy(
+                        hfab.dataPtr(), fab.dataPtr(), fab.nBytes());
+                    amrex::Gpu::dtoh_memcpy(
+                        hifab.dataPtr(), ifab.dataPtr(), ifab.nBytes());
+                    const auto q = hfab.array();
+                    const auto ibl = hifab.const_array();
+#else
+                    const auto q = fab.array();
+                    const auto ibl = ifab.const_array();
+#endif
+                    // receptor cells/nodes are the ones flagged as fringe
+                    amrex::LoopOnCpu(bx, [&](int i, int j, int k) {
+                        if (ibl(i, j, k) != -1) return;
+                        for (int n = 0; n < ncomp; ++n) visit(q(i, j, k, n));
+                    });
+#ifdef AMREX_USE_GPU
+                    if (modify) {
+                        amrex::Gpu::htod_memcpy(
+                            fab.dataPtr(), hfab.dataPtr(), fab.nBytes());
+                    }
+#endif
+                }
+            }
+        }
+    }
+}
+
+void AMRWind::get_fringe_values(std::vector<double>& vals)
+{
+    vals.clear();
+    visit_fringe_values(false, [&vals](double& q) { vals.push_back(q); });
+}
+
+void AMRWind::set_fringe_values(const std::vector<double>& vals)
+{
+    size_t idx = 0;
+    visit_fringe_values(true, [&vals, &idx](double& q) {
+        if (idx < vals.size()) q = vals[idx++];
+    });
+}
 
 int AMRWind::overset_update_interval()
 {
@@ -126,6 +293,23 @@ int AMRWind::overset_update_interval()
     return regrid_int > 0 ? regrid_int : 100000000;
 }
 
+bool AMRWind::mesh_changed()
+{
+    // Regridding does not necessarily change the grid hierarchy
+    if (!m_has_conn) return true;
+    return m_tgiface.grid_fingerprint() != m_conn_fingerprint;
+}
+
+bool AMRWind::needs_amr_preprocessing()
+{
+    return m_tgiface.grid_registered();
+}
+
+bool AMRWind::has_prescribed_motion()
+{
+    return m_incflo.sim().time().regrid_interval() <= 0;
+}
+
 int AMRWind::time_index() { return m_incflo.sim().time().time_index(); }
 
 } // namespace exawind
@@ -15,6 +15,26 @@ private:
     AMRTiogaIface m_tgiface;
     std::vector<std::string> m_cell_vars;
     std::vector<std::string> m_node_vars;
+    //! Fields registered with the next solution exchange
+    std::vector<std::string> m_exchange_cell_vars;
+    std::vector<std::string> m_exchange_node_vars;
+    //! Fraction of the last step at which the solution is exchanged. Only
+    //! cell fields with an old state are interpolated in time, the node
+    //! fields and the single state fields go with their end of step values.
+    double m_exchange_time_fraction{1.0};
+    //! Flag indicating whether the fields without time interpolation have
+    //! been reported
+    bool m_reported_end_values{false};
+    //! Fingerprint of the grid hierarchy at the last connectivity update
+    std::size_t m_conn_fingerprint{0};
+    //! Flag indicating whether the connectivity has been computed
+    bool m_has_conn{false};
+    //! Flag indicating whether stage2 may overlap the solution exchange
+    bool m_overlap_stage2{false};
+
+    //! Apply a visitor to the exchanged field values at the receptor points
+    template <typename Visitor>
+    void visit_fringe_values(const bool modify, Visitor&& visit);
 
 public:
     static void
@@ -29,9 +49,22 @@ public:
     bool is_amr() override { return true; }
     bool is_fixed_timestep_size() override;
     int overset_update_interval() override;
+    bool has_prescribed_motion() override;
+    bool mesh_changed() override;
+    bool needs_amr_preprocessing() override;
+    //! Stage2 only runs the physics pre-advance work (source terms). Whether
+    //! that leaves the exchanged fields alone depends on the physics, so it
+    //! has to be enabled with set_overlap_stage2.
+    bool stage2_preserves_exchanged_fields() override
+    {
+        return m_overlap_stage2;
+    }
+    //! Let the stage2 work run while the solution exchange is in flight
+    void set_overlap_stage2(const bool overlap) { m_overlap_stage2 = overlap; }
     int time_index() override;
     std::string identifier() override { return "AMR-Wind"; }
     MPI_Comm comm() override { return m_comm; }
+    std::vector<std::string> exchange_fields() override;
 
 protected:
     void init_prolog(bool multi_solver_mode = true) override;
@@ -49,9 +82,20 @@ protected:
     void post_advance() override;
     void pre_overset_conn_work() override;
     void post_overset_conn_work() override;
+    void predict_overset_mesh(const double) override;
+    void select_exchange_fields(
+        const ExchangeSchedule& schedule,
+        const bool first,
+        const bool last) override;
     void register_solution() override;
     void update_solution() override;
     void dump_simulation_time() override {};
+    void set_exchange_time_fraction(const double frac) override
+    {
+        m_exchange_time_fraction = frac;
+    };
+    void get_fringe_values(std::vector<double>& vals) override;
+    void set_fringe_values(const std::vector<double>& vals) override;
     MPI_Comm m_comm;
 };
 
@@ -0,0 +1,148 @@
+#include "AutoPartition.h"
+#include "exodusII.h"
+#include <algorithm>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+namespace exawind {
+
+namespace {
+
+//! Number of elements of a mesh file, or of a generated mesh specification
+double mesh_file_size(const std::string& mesh)
+{
+    const std::string generated = "generated:";
+    if (mesh.rfind(generated, 0) == 0) {
+        // e.g., generated:10x20x30|bbox:...
+        std::istringstream dims(
+            mesh.substr(generated.size(), mesh.find('|') - generated.size()));
+        std::string dim;
+        double nelem = 1.0;
+        while (std::getline(dims, dim, 'x')) nelem *= std::stod(dim);
+        return nelem;
+    }
+
+    int cpu_word_size = sizeof(double);
+    int io_word_size = 0;
+    float version;
+    const int exoid = ex_open(
+        mesh.c_str(), EX_READ, &cpu_word_size, &io_word_size, &version);
+    if (exoid < 0) {
+        throw std::runtime_error("Unable to open the Exodus mesh " + mesh);
+    }
+    ex_init_params params;
+    const int ierr = ex_get_init_ext(exoid, &params);
+    ex_close(exoid);
+    if (ierr < 0) {
+        throw std::runtime_error(
+            "Unable to read the Exodus header of mesh " + mesh);
+    }
+    return static_cast<double>(params.num_elem);
+}
+
+//! Values of a key of an AMReX input file
+std::vector<std::string>
+amr_input_values(const std::string& inpfile, const std::string& key)
+{
+    std::ifstream inp(inpfile);
+    if (!inp.is_open()) {
+        throw std::runtime_error("Unable to open AMR-Wind input " + inpfile);
+    }
+    std::vector<std::string> values;
+    std::string line;
+    while (std::getline(inp, line)) {
+        line = line.substr(0, line.find('#'));
+        const auto eq = line.find('=');
+        if (eq == std::string::npos) continue;
+        std::istringstream lhs(line.substr(0, eq));
+        std::string name;
+        lhs >> name;
+        if (name != key) continue;
+
+        // The last occurrence wins, as with ParmParse queries
+        values.clear();
+        std::istringstream rhs(line.substr(eq + 1));
+        std::string val;
+        while (rhs >> val) values.push_back(val);
+    }
+    return values;
+}
+
+} // namespace
+
+double nalu_mesh_size(const YAML::Node& nalu_yaml)
+{
+    double nelem = 0.0;
+    for (const auto& realm : nalu_yaml["realms"]) {
+        if (realm["mesh"]) {
+            nelem += mesh_file_size(realm["mesh"].as<std::string>());
+        }
+    }
+    return nelem;
+}
+
+double amr_mesh_size(const std::string& inpfile, const double refined_fraction)
+{
+    const auto n_cell = amr_input_values(inpfile, "amr.n_cell");
+    if (n_cell.empty()) {
+        throw std::runtime_error("amr.n_cell not found in " + inpfile);
+    }
+    double base_cells = 1.0;
+    for (const auto& nc : n_cell) base_cells *= std::stod(nc);
+
+    const auto max_level = amr_input_values(inpfile, "amr.max_level");
+    const int nlevels = max_level.empty() ? 0 : std::stoi(max_level[0]);
+    const auto ref_ratio = amr_input_values(inpfile, "amr.ref_ratio");
+
+    double cells = base_cells;
+    double level_cells = base_cells;
+    for (int lev = 1; lev <= nlevels; ++lev) {
+        // One ratio per level, the last one applies to the finer levels
+        const int idx =
+            std::min(lev - 1, static_cast<int>(ref_ratio.size()) - 1);
+        const double ratio =
+            ref_ratio.empty() ? 2.0 : std::stod(ref_ratio[idx]);
+        level_cells *= refined_fraction * ratio * ratio * ratio;
+        cells += level_cells;
+    }
+    return cells;
+}
+
+std::vector<int>
+partition_ranks(const std::vector<double>& costs, const int num_ranks)
+{
+    const int nsolvers = static_cast<int>(costs.size());
+    if (num_ranks < nsolvers) {
+        throw std::runtime_error(
+            "Automatic partitioning needs at least one rank per solver");
+    }
+
+    // Give each additional rank to the solver with the largest cost per rank
+    std::vector<int> ranks(nsolvers, 1);
+    for (int r = nsolvers; r < num_ranks; ++r) {
+        int imax = 0;
+        for (int i = 1; i < nsolvers; ++i) {
+            if (costs[i] / ranks[i] > costs[imax] / ranks[imax]) imax = i;
+        }
+        ++ranks[imax];
+    }
+    return ranks;
+}
+
+double predicted_imbalance(
+    const std::vector<double>& costs, const std::vector<int>& ranks)
+{
+    const double total_cost = std::accumulate(costs.begin(), costs.end(), 0.0);
+    const int total_ranks = std::accumulate(ranks.begin(), ranks.end(), 0);
+    if ((total_cost <= 0.0) || (total_ranks < 1)) return 0.0;
+
+    double max_cost = 0.0;
+    for (size_t i = 0; i < costs.size(); ++i) {
+        max_cost = std::max(max_cost, costs[i] / ranks[i]);
+    }
+    return max_cost / (total_cost / total_ranks) - 1.0;
+}
+
+} // namespace exawind
@@ -0,0 +1,30 @@
+#ifndef AUTOPARTITION_H
+#define AUTOPARTITION_H
+
+#include "yaml-cpp/yaml.h"
+#include <string>
+#include <vector>
+
+namespace exawind {
+
+//! Number of elements of the meshes of a Nalu-Wind input, read from the
+//! Exodus file headers (or the sizes of generated meshes)
+double nalu_mesh_size(const YAML::Node& nalu_yaml);
+
+//! Estimated number of cells of an AMR-Wind input. The base grid, maximum
+//! level and refinement ratio are read from the input file, each level is
+//! assumed to refine a fraction of the level below.
+double amr_mesh_size(const std::string& inpfile, const double refined_fraction);
+
+//! Split a number of ranks proportionally to the costs, with at least one
+//! rank per solver
+std::vector<int>
+partition_ranks(const std::vector<double>& costs, const int num_ranks);
+
+//! Predicted load imbalance of a partition: the largest cost per rank
+//! relative to the average cost per rank, minus one
+double predicted_imbalance(
+    const std::vector<double>& costs, const std::vector<int>& ranks);
+
+} // namespace exawind
+#endif /* AUTOPARTITION_H */
@@ -0,0 +1,130 @@
+#include "CollectiveBatch.h"
+#include <stdexcept>
+
+namespace exawind {
+
+CollectiveBatch::~CollectiveBatch() { free_requests(); }
+
+int CollectiveBatch::add(const Op op, const double value)
+{
+    // The buffers change size, persistent requests have to be set up again
+    free_requests();
+
+    const int slot = static_cast<int>(m_slots.size());
+    if (op == Op::Sum) {
+        m_slots.push_back({op, static_cast<int>(m_sum_send.size())});
+        m_sum_send.push_back(0.0);
+        m_sum_recv.push_back(0.0);
+    } else {
+        m_slots.push_back({op, static_cast<int>(m_max_send.size())});
+        m_max_send.push_back(0.0);
+        m_max_recv.push_back(0.0);
+    }
+    set(slot, value);
+    return slot;
+}
+
+void CollectiveBatch::set(const int slot, const double value)
+{
+    const auto& sl = m_slots.at(slot);
+    switch (sl.op) {
+    case Op::Min:
+        m_max_send[sl.index] = -value;
+        break;
+    case Op::Max:
+        m_max_send[sl.index] = value;
+        break;
+    case Op::Sum:
+        m_sum_send[sl.index] = value;
+        break;
+    case Op::LogicalOr:
+        m_max_send[sl.index] = (value != 0.0) ? 1.0 : 0.0;
+        break;
+    case Op::LogicalAnd:
+        // and(x) = not(or(not(x)))
+        m_max_send[sl.index] = (value != 0.0) ? 0.0 : 1.0;
+        break;
+    }
+}
+
+double CollectiveBatch::get(const int slot) const
+{
+    const auto& sl = m_slots.at(slot);
+    switch (sl.op) {
+    case Op::Min:
+        return -m_max_recv[sl.index];
+    case Op::Max:
+    case Op::LogicalOr:
+        return m_max_recv[sl.index];
+    case Op::Sum:
+        return m_sum_recv[sl.index];
+    case Op::LogicalAnd:
+        return 1.0 - m_max_recv[sl.index];
+    }
+    return 0.0;
+}
+
+void CollectiveBatch::reduce()
+{
+    if (m_comm == MPI_COMM_NULL) {
+        throw std::runtime_error("CollectiveBatch: invalid communicator");
+    }
+    const int nmax = static_cast<int>(m_max_send.size());
+    const int nsum = static_cast<int>(m_sum_send.size());
+
+#if MPI_VERSION >= 4
+    if (!m_persistent) {
+        if (nmax > 0) {
+            MPI_Allreduce_init(
+                m_max_send.data(), m_max_recv.data(), nmax, MPI_DOUBLE,
+                MPI_MAX, m_comm, MPI_INFO_NULL, &m_max_request);
+        }
+        if (nsum > 0) {
+            MPI_Allreduce_init(
+                m_sum_send.data(), m_sum_recv.data(), nsum, MPI_DOUBLE,
+                MPI_SUM, m_comm, MPI_INFO_NULL, &m_sum_request);
+        }
+        m_persistent = true;
+    }
+    if (nmax > 0) MPI_Start(&m_max_request);
+    if (nsum > 0) MPI_Start(&m_sum_request);
+    if (nmax > 0) MPI_Wait(&m_max_request, MPI_STATUS_IGNORE);
+    if (nsum > 0) MPI_Wait(&m_sum_request, MPI_STATUS_IGNORE);
+#else
+    if (nmax > 0) {
+        MPI_Allreduce(
+            m_max_send.data(), m_max_recv.data(), nmax, MPI_DOUBLE, MPI_MAX,
+            m_comm);
+    }
+    if (nsum > 0) {
+        MPI_Allreduce(
+            m_sum_send.data(), m_sum_recv.data(), nsum, MPI_DOUBLE, MPI_SUM,
+            m_comm);
+    }
+#endif
+}
+
+void CollectiveBatch::clear()
+{
+    free_requests();
+    m_slots.clear();
+    m_max_send.clear();
+    m_max_recv.clear();
+    m_sum_send.clear();
+    m_sum_recv.clear();
+}
+
+void CollectiveBatch::free_requests()
+{
+    if (!m_persistent) return;
+    m_persistent = false;
+
+    // Requests cannot be freed once MPI is finalized
+    int finalized = 0;
+    MPI_Finalized(&finalized);
+    if (finalized != 0) return;
+    if (m_max_request != MPI_REQUEST_NULL) MPI_Request_free(&m_max_request);
+    if (m_sum_request != MPI_REQUEST_NULL) MPI_Request_free(&m_sum_request);
+}
+
+} // namespace exawind
@@ -0,0 +1,68 @@
+#ifndef COLLECTIVEBATCH_H
+#define COLLECTIVEBATCH_H
+
+#include "mpi.h"
+#include <vector>
+
+namespace exawind {
+
+//! Batches driver-level scalar reductions into as few collectives as possible
+//!
+//! Values are registered once as slots with a reduction operation and are
+//! all reduced by a single call to reduce(). Min, max and logical reductions
+//! are folded into one max reduction (min values are negated, logical values
+//! become 0 or 1), sums use a second reduction only when sum slots exist.
+//! When MPI provides persistent collectives (MPI 4), the reductions are set
+//! up on the first call and only restarted afterwards.
+class CollectiveBatch
+{
+public:
+    enum class Op { Min, Max, Sum, LogicalOr, LogicalAnd };
+
+    explicit CollectiveBatch(MPI_Comm comm = MPI_COMM_NULL) : m_comm(comm) {}
+
+    ~CollectiveBatch();
+
+    CollectiveBatch(const CollectiveBatch&) = delete;
+    CollectiveBatch& operator=(const CollectiveBatch&) = delete;
+
+    //! Add a slot and return its index
+    int add(const Op op, const double value = 0.0);
+
+    //! Set the local value of a slot
+    void set(const int slot, const double value);
+
+    //! Reduced value of a slot after reduce()
+    double get(const int slot) const;
+
+    //! Reduce all slots over the communicator
+    void reduce();
+
+    //! Remove all slots
+    void clear();
+
+    int num_slots() const { return static_cast<int>(m_slots.size()); }
+
+private:
+    struct Slot
+    {
+        Op op;
+        //! Index in the max or the sum buffer
+        int index;
+    };
+
+    void free_requests();
+
+    MPI_Comm m_comm;
+    std::vector<Slot> m_slots;
+    std::vector<double> m_max_send;
+    std::vector<double> m_max_recv;
+    std::vector<double> m_sum_send;
+    std::vector<double> m_sum_recv;
+    MPI_Request m_max_request{MPI_REQUEST_NULL};
+    MPI_Request m_sum_request{MPI_REQUEST_NULL};
+    bool m_persistent{false};
+};
+
+} // namespace exawind
+#endif /* COLLECTIVEBATCH_H */
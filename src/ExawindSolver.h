@@ -3,6 +3,11 @@
 
 #include "Timers.h"
 #include "ParallelPrinter.h"
+#include "ExchangeSchedule.h"
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 namespace exawind {
 
@@ -19,73 +24,101 @@ public:
     void call_init_epilog() { init_epilog(); };
     void call_prepare_solver_prolog() { prepare_solver_prolog(); };
     void call_prepare_solver_epilog() { prepare_solver_epilog(); };
-    void call_pre_advance_stage0(size_t inonlin, const bool increment)
+    //! The Pre timer adds up the stage work of a timestep, it is restarted
+    //! by reset_step_timers
+    void call_pre_advance_stage0(size_t inonlin)
     {
         const std::string name = "Pre";
-        m_timers.tick(name, increment);
+        m_timers.tick(name, true);
+        const auto work_start = WorkClockT::now();
         pre_advance_stage0(inonlin);
+        add_step_work(work_start);
         m_timers.tock(name);
     }
-    void call_pre_advance_stage1(size_t inonlin, const bool increment)
+    void call_pre_advance_stage1(size_t inonlin)
     {
         const std::string name = "Pre";
-        m_timers.tick(name, increment);
+        m_timers.tick(name, true);
+        const auto work_start = WorkClockT::now();
         pre_advance_stage1(inonlin);
+        add_step_work(work_start);
         m_timers.tock(name);
     };
-    void call_pre_advance_stage2(size_t inonlin, const bool increment)
+    void call_pre_advance_stage2(size_t inonlin)
     {
         const std::string name = "Pre";
-        m_timers.tick(name, increment);
+        m_timers.tick(name, true);
+        const auto work_start = WorkClockT::now();
         pre_advance_stage2(inonlin);
+        add_step_work(work_start);
         m_timers.tock(name);
     };
     double call_get_time()
     {
         const std::string name = "Pre";
-        m_timers.tick(name);
+        m_timers.tick(name, true);
+        const auto work_start = WorkClockT::now();
         double time = get_time();
+        add_step_work(work_start);
         m_timers.tock(name);
         return time;
     }
     double call_get_timestep_size()
     {
         const std::string name = "Pre";
-        m_timers.tick(name);
+        m_timers.tick(name, true);
+        const auto work_start = WorkClockT::now();
         double dt = get_timestep_size();
+        add_step_work(work_start);
+        m_timers.tock(name);
+        return dt;
+    };
+    double call_estimate_timestep_size()
+    {
+        const std::string name = "Pre";
+        m_timers.tick(name, true);
+        const auto work_start = WorkClockT::now();
+        double dt = estimate_timestep_size();
+        add_step_work(work_start);
         m_timers.tock(name);
         return dt;
     };
     void call_set_timestep_size(double dt)
     {
         const std::string name = "Pre";
-        m_timers.tick(name);
+        m_timers.tick(name, true);
+        const auto work_start = WorkClockT::now();
         set_timestep_size(dt);
+        add_step_work(work_start);
         m_timers.tock(name);
     };
     void call_advance_timestep(size_t inonlin, const bool increment)
     {
         const std::string name = "Solve";
         m_timers.tick(name, increment);
+        const auto work_start = WorkClockT::now();
         advance_timestep(inonlin);
+        add_step_work(work_start);
         m_timers.tock(name);
     };
-    void call_additional_picard_iterations(const int n)
+    void
+    call_additional_picard_iterations(const int n, const bool increment = false)
     {
         std::string name = "AdditionalPicardIterations";
-        if (std::find(m_names.begin(), m_names.end(), name) == m_names.end()) {
-            m_timers.addTimer(name);
-            m_names.push_back(name);
-        }
-        m_timers.tick(name);
+        add_timer(name);
+        m_timers.tick(name, increment);
+        const auto work_start = WorkClockT::now();
         additional_picard_iterations(n);
+        add_step_work(work_start);
         m_timers.tock(name);
     };
     void call_post_advance()
     {
         const std::string name = "Post";
         m_timers.tick(name);
+        const auto work_start = WorkClockT::now();
         post_advance();
+        add_step_work(work_start);
         m_timers.tock(name);
     };
     void call_pre_overset_conn_work()
@@ -102,14 +135,35 @@ public:
         post_overset_conn_work();
         m_timers.tock(name);
     };
-    void call_register_solution()
+    void call_predict_overset_mesh(const double time)
+    {
+        const std::string name = "PreConn";
+        m_timers.tick(name, true);
+        predict_overset_mesh(time);
+        m_timers.tock(name);
+    };
+    //! Measured once per step, apart from the connectivity work
+    double call_mesh_motion()
+    {
+        const std::string name = "MeshMotion";
+        add_timer(name);
+        m_timers.tick(name);
+        const double motion = mesh_motion();
+        m_timers.tock(name);
+        return motion;
+    };
+    //! Pack the fields due at the start of a solution exchange
+    void call_begin_exchange(
+        const ExchangeSchedule& schedule, const bool first, const bool last)
     {
         const std::string name = "Register";
         m_timers.tick(name);
+        select_exchange_fields(schedule, first, last);
         register_solution();
         m_timers.tock(name);
     };
-    void call_update_solution()
+    //! Unpack the received fringe values at the end of a solution exchange
+    void call_end_exchange()
     {
         const std::string name = "Update";
         m_timers.tick(name);
@@ -117,16 +171,58 @@ public:
         m_timers.tock(name);
     };
 
+    //! The Fringe timer adds up the fringe value work of a timestep, it is
+    //! restarted by reset_step_timers
+    void call_get_fringe_values(std::vector<double>& vals)
+    {
+        const std::string name = "Fringe";
+        add_timer(name);
+        m_timers.tick(name, true);
+        get_fringe_values(vals);
+        m_timers.tock(name);
+    };
+    void call_set_fringe_values(const std::vector<double>& vals)
+    {
+        const std::string name = "Fringe";
+        add_timer(name);
+        m_timers.tick(name, true);
+        set_fringe_values(vals);
+        m_timers.tock(name);
+    };
+
+    double call_nonlinear_residual() { return nonlinear_residual(); };
+
     void call_dump_simulation_time() { dump_simulation_time(); };
+    void call_set_exchange_time_fraction(const double frac)
+    {
+        set_exchange_time_fraction(frac);
+    };
 
     virtual bool is_unstructured() { return false; };
     virtual bool is_amr() { return false; };
     virtual bool is_fixed_timestep_size() = 0;
     virtual int overset_update_interval() { return 100000000; };
+    //! True if the mesh moves during time integration
+    virtual bool has_moving_mesh() { return false; };
+    //! True if the mesh has changed since the last connectivity update
+    virtual bool mesh_changed() { return true; };
+    //! True if the AMR grid registered with TIOGA has to be preprocessed
+    virtual bool needs_amr_preprocessing() { return false; };
+    //! True if pre_advance_stage2 does not modify the exchanged fields, so
+    //! that it can run while the solution exchange is in flight
+    virtual bool stage2_preserves_exchanged_fields() { return false; };
+    //! True if the mesh position is known ahead of time
+    virtual bool has_prescribed_motion() { return false; };
     virtual int time_index() = 0;
     virtual std::string identifier() { return "ExawindSolver"; }
+    //! Index of the solver within the simulation: 0 for the background
+    //! solver, from 1 for the near-body solvers
+    virtual int instance_id() { return 0; }
     virtual MPI_Comm comm() = 0;
     virtual int get_ncomps() { return 0; };
+    //! Names of the exchanged fields, in the order in which TIOGA
+    //! interpolates their components
+    virtual std::vector<std::string> exchange_fields() { return {}; };
     void timing_details();
     //! Timer names
     std::vector<std::string> m_names{
@@ -134,7 +230,67 @@ public:
     //! Timers
     Timers m_timers;
 
+    //! Set the number of outer nonlinear and additional Picard iterations of
+    //! this solver. A count of -1 uses the count given to the driver.
+    void set_iteration_budget(const int nonlinear_its, const int picard_its)
+    {
+        if ((nonlinear_its == 0) || (nonlinear_its < -1)) {
+            throw std::runtime_error(
+                "A solver needs at least one nonlinear iteration");
+        }
+        if (picard_its < -1) {
+            throw std::runtime_error(
+                "A solver cannot do a negative number of Picard iterations");
+        }
+        m_nonlinear_its = nonlinear_its;
+        m_picard_its = picard_its;
+    };
+    int nonlinear_iterations(const int default_its) const
+    {
+        return m_nonlinear_its < 0 ? default_its : m_nonlinear_its;
+    };
+    int picard_iterations(const int default_its) const
+    {
+        return m_picard_its < 0 ? default_its : m_picard_its;
+    };
+
+    //! Restart the timers that add up over the calls of a timestep
+    void reset_step_timers()
+    {
+        m_timers.reset("Pre");
+        m_timers.reset("Fringe");
+        m_step_work = 0.0;
+    };
+
+    //! Time in milliseconds spent in the Pre, Solve, Picard and Post work of
+    //! the current timestep, without the truncation of the timers
+    double step_work() const { return m_step_work; }
+
+    //! Add a timer that is not part of the default set
+    void add_timer(const std::string& name)
+    {
+        if (std::find(m_names.begin(), m_names.end(), name) == m_names.end()) {
+            m_timers.addTimer(name);
+            m_names.push_back(name);
+        }
+    };
+
 protected:
+    using WorkClockT = std::chrono::steady_clock;
+    using WorkTimeT = std::chrono::duration<double, std::milli>;
+
+    //! Work of the current timestep, restarted by reset_step_timers
+    double m_step_work{0.0};
+
+    void add_step_work(const WorkClockT::time_point start)
+    {
+        m_step_work += WorkTimeT(WorkClockT::now() - start).count();
+    }
+
+    //! Iteration counts of this solver (negative to use the driver counts)
+    int m_nonlinear_its{-1};
+    int m_picard_its{-1};
+
     virtual void init_prolog(bool multi_solver_mode = true) = 0;
     virtual void init_epilog() = 0;
     virtual void prepare_solver_prolog() = 0;
@@ -145,14 +301,37 @@ protected:
     virtual double get_time() = 0;
     virtual double get_timestep_size() = 0;
     virtual void set_timestep_size(const double) = 0;
+    //! Size of the next step the solver would take on its own, before its
+    //! stage0 work has run
+    virtual double estimate_timestep_size() { return get_timestep_size(); };
     virtual void advance_timestep(size_t inonlin) = 0;
     virtual void additional_picard_iterations(const int) = 0;
     virtual void post_advance() = 0;
     virtual void pre_overset_conn_work() = 0;
     virtual void post_overset_conn_work() = 0;
+    //! Select the fields registered by the next register_solution call
+    virtual void
+    select_exchange_fields(const ExchangeSchedule&, const bool, const bool){};
     virtual void register_solution() = 0;
     virtual void update_solution() = 0;
     virtual void dump_simulation_time() = 0;
+    //! Exchange the solution interpolated in time at a fraction of the last
+    //! step. Used by solvers that are ahead of the exchange time.
+    virtual void set_exchange_time_fraction(const double) {};
+    //! Pack the values of the exchanged fields at the receptor points
+    virtual void get_fringe_values(std::vector<double>& vals) { vals.clear(); };
+    //! Overwrite the receptor values with values packed as in
+    //! get_fringe_values
+    virtual void set_fringe_values(const std::vector<double>&) {};
+    //! Register the overset mesh at its position at a later time with TIOGA,
+    //! without changing the solver mesh. Only called if
+    //! has_prescribed_motion() is true.
+    virtual void predict_overset_mesh(const double) {};
+    //! Largest displacement of the fringe points since the last connectivity
+    //! relative to the local mesh size, negative if the mesh does not move
+    virtual double mesh_motion() { return -1.0; };
+    //! Nonlinear residual of the last iteration, negative if not available
+    virtual double nonlinear_residual() { return -1.0; };
 };
 
 } // namespace exawind
@@ -0,0 +1,93 @@
+#ifndef EXCHANGESCHEDULE_H
+#define EXCHANGESCHEDULE_H
+
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace exawind {
+
+//! Schedule of the exchanged fields within a timestep
+//!
+//! Each field is exchanged at every solution exchange of a timestep (the
+//! default), only at the first one, or only at the last one. The exchanges
+//! following a connectivity update are both first and last, so that they
+//! provide all fields at the new fringe points.
+//!
+//! TIOGA matches the exchanged components of the meshes by position, so the
+//! schedule is set by position in the exchanged field lists: the solvers
+//! name the same quantity differently (e.g., pressure and p), but exchange it
+//! at the same position. Every solver then selects the same positions.
+class ExchangeSchedule
+{
+public:
+    enum class When { Always, First, Last };
+
+    //! Set when the fields at a position are exchanged: "always", "first" or
+    //! "last". The field name is only used in error messages.
+    void set(
+        const int position, const std::string& field, const std::string& when)
+    {
+        When value;
+        if (when == "always") {
+            value = When::Always;
+        } else if (when == "first") {
+            value = When::First;
+        } else if (when == "last") {
+            value = When::Last;
+        } else {
+            throw std::runtime_error(
+                "Invalid exchange schedule '" + when + "' for field " + field +
+                ". Valid options are: always, first, last");
+        }
+        if (position < 0) {
+            throw std::runtime_error(
+                "Exchange schedule for field " + field +
+                " that is not exchanged");
+        }
+        const auto it = m_when.find(position);
+        if ((it != m_when.end()) && (it->second.first != value)) {
+            throw std::runtime_error(
+                "Conflicting exchange schedules for fields " +
+                it->second.second + " and " + field +
+                ", exchanged at the same position");
+        }
+        m_when[position] = {value, field};
+    }
+
+    bool empty() const { return m_when.empty(); }
+
+    //! Number of positions the schedule refers to
+    int num_positions() const
+    {
+        return m_when.empty() ? 0 : m_when.rbegin()->first + 1;
+    }
+
+    //! True if the fields at a position are due at an exchange
+    bool due(const int position, const bool first, const bool last) const
+    {
+        if (first && last) return true;
+        const auto it = m_when.find(position);
+        if (it == m_when.end()) return true;
+        const When when = it->second.first;
+        return (when == When::Always) || ((when == When::First) && first) ||
+               ((when == When::Last) && last);
+    }
+
+    //! True if any of the fields of a list is due at an exchange
+    bool
+    any_due(const int num_fields, const bool first, const bool last) const
+    {
+        for (int pos = 0; pos < num_fields; ++pos) {
+            if (due(pos, first, last)) return true;
+        }
+        return false;
+    }
+
+private:
+    std::map<int, std::pair<When, std::string>> m_when;
+};
+
+} // namespace exawind
+#endif /* EXCHANGESCHEDULE_H */
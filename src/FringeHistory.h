@@ -0,0 +1,113 @@
+#ifndef FRINGEHISTORY_H
+#define FRINGEHISTORY_H
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <utility>
+#include <vector>
+
+namespace exawind {
+
+//! Short history of exchanged fringe values for extrapolation in time
+//!
+//! Each level holds the receptor values of a solver, as packed by
+//! ExawindSolver::call_get_fringe_values, at a given time. Levels are kept
+//! in increasing time order; storing values at the time of the latest level
+//! replaces that level.
+class FringeHistory
+{
+    std::deque<std::pair<double, std::vector<double>>> m_levels;
+    int m_max_levels{3};
+
+    static bool same_time(const double t1, const double t2)
+    {
+        return std::abs(t1 - t2) <=
+               1.0e-12 * std::max({1.0, std::abs(t1), std::abs(t2)});
+    }
+
+    //! Lagrange weights of the last n levels evaluated at time
+    std::vector<double> weights(const double time, const int n) const
+    {
+        const int first = static_cast<int>(m_levels.size()) - n;
+        std::vector<double> wts(n, 1.0);
+        for (int i = 0; i < n; ++i) {
+            const double ti = m_levels[first + i].first;
+            for (int j = 0; j < n; ++j) {
+                if (j == i) continue;
+                const double tj = m_levels[first + j].first;
+                wts[i] *= (time - tj) / (ti - tj);
+            }
+        }
+        return wts;
+    }
+
+public:
+    explicit FringeHistory(const int max_levels = 3) : m_max_levels(max_levels)
+    {}
+
+    void clear() { m_levels.clear(); }
+
+    int num_levels() const { return static_cast<int>(m_levels.size()); }
+
+    //! Store the fringe values at a given time
+    void push(const double time, std::vector<double>&& vals)
+    {
+        if (!m_levels.empty() &&
+            (m_levels.back().second.size() != vals.size())) {
+            // The fringe points have changed, older levels are meaningless
+            m_levels.clear();
+        }
+        if (!m_levels.empty() && same_time(m_levels.back().first, time)) {
+            m_levels.back().second = std::move(vals);
+            return;
+        }
+        m_levels.emplace_back(time, std::move(vals));
+        while (static_cast<int>(m_levels.size()) > m_max_levels) {
+            m_levels.pop_front();
+        }
+    }
+
+    //! Extrapolate the fringe values to a given time with a polynomial of at
+    //! most the requested order
+    void extrapolate(
+        const double time, const int order, std::vector<double>& vals) const
+    {
+        vals.clear();
+        if (m_levels.empty()) return;
+        const int n = std::min(order + 1, num_levels());
+        const int first = num_levels() - n;
+        const auto wts = weights(time, n);
+        vals.assign(m_levels.back().second.size(), 0.0);
+        for (int i = 0; i < n; ++i) {
+            const auto& lvl = m_levels[first + i].second;
+            for (size_t k = 0; k < vals.size(); ++k) {
+                vals[k] += wts[i] * lvl[k];
+            }
+        }
+    }
+
+    //! Relative max-norm difference between the extrapolated and the given
+    //! values. Returns a negative number if there is nothing to compare to.
+    double prediction_error(
+        const double time,
+        const int order,
+        const std::vector<double>& vals) const
+    {
+        if (m_levels.empty() || (m_levels.back().second.size() != vals.size()))
+            return -1.0;
+
+        std::vector<double> pred;
+        extrapolate(time, order, pred);
+        double err = 0.0;
+        double scale = 0.0;
+        for (size_t k = 0; k < vals.size(); ++k) {
+            err = std::max(err, std::abs(pred[k] - vals[k]));
+            scale = std::max(scale, std::abs(vals[k]));
+        }
+        return scale > 0.0 ? err / scale : err;
+    }
+};
+
+} // namespace exawind
+#endif /* FRINGEHISTORY_H */
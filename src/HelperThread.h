@@ -0,0 +1,103 @@
+#ifndef HELPERTHREAD_H
+#define HELPERTHREAD_H
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace exawind {
+
+//! Persistent worker thread running one task at a time
+//!
+//! The thread is created with the first task and waits for the next one in
+//! between, so that tasks started at every exchange do not pay for a thread
+//! creation. An exception thrown by a task is rethrown by wait().
+class HelperThread
+{
+public:
+    HelperThread() = default;
+    HelperThread(const HelperThread&) = delete;
+    HelperThread& operator=(const HelperThread&) = delete;
+
+    ~HelperThread()
+    {
+        if (!m_thread.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        m_thread.join();
+    }
+
+    //! Run a task on the worker. The previous task must have been waited for.
+    void start(std::function<void()> task)
+    {
+        if (!m_thread.joinable()) {
+            m_thread = std::thread([this]() { loop(); });
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_task = std::move(task);
+            m_busy = true;
+        }
+        m_pending = true;
+        m_cv.notify_all();
+    }
+
+    //! True if a task was started and not waited for
+    bool pending() const { return m_pending; }
+
+    //! Wait for the last task to finish
+    void wait()
+    {
+        if (!m_pending) return;
+        m_pending = false;
+        std::exception_ptr error;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this]() { return !m_busy; });
+            std::swap(error, m_error);
+        }
+        if (error) std::rethrow_exception(error);
+    }
+
+private:
+    void loop()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            m_cv.wait(lock, [this]() { return m_busy || m_stop; });
+            if (m_stop) return;
+            auto task = std::move(m_task);
+            lock.unlock();
+            std::exception_ptr error;
+            try {
+                task();
+            } catch (...) {
+                error = std::current_exception();
+            }
+            lock.lock();
+            m_error = error;
+            m_busy = false;
+            m_cv.notify_all();
+        }
+    }
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::function<void()> m_task;
+    std::exception_ptr m_error;
+    //! Flag indicating whether the worker runs a task (guarded by m_mutex)
+    bool m_busy{false};
+    bool m_stop{false};
+    //! Flag indicating whether a task awaits wait(), only used by the caller
+    bool m_pending{false};
+};
+
+} // namespace exawind
+#endif /* HELPERTHREAD_H */
@@ -0,0 +1,163 @@
+#ifndef IDLETRACKER_H
+#define IDLETRACKER_H
+
+#include "mpi.h"
+#include "Timers.h"
+#include <chrono>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace exawind {
+
+//! Tracks the local work done between the synchronization points of a step
+//!
+//! A segment is the work between two points where the lockstep loop
+//! synchronizes all solvers (solution exchange, connectivity, dt reduction).
+//! A group is the work between two synchronizations that are actually
+//! performed. In lockstep mode segments and groups coincide, in lagged
+//! coupling modes a group spans several segments. Reducing the maximum of
+//! both over all ranks gives the critical path of the lockstep loop and of
+//! the loop that was actually run, the difference is the idle time recovered.
+class IdleTracker
+{
+    using ClockT = std::chrono::steady_clock;
+    using TimeT = std::chrono::duration<double, std::milli>;
+
+    ClockT::time_point m_start;
+    ClockT::time_point m_step_start;
+    double m_step_time{0.0};
+    std::vector<double> m_segments;
+    std::vector<double> m_groups;
+    double m_group_work{0.0};
+    bool m_running{false};
+
+    void close_segment()
+    {
+        if (!m_running) return;
+        const double work = TimeT(ClockT::now() - m_start).count();
+        m_segments.push_back(work);
+        m_group_work += work;
+        m_running = false;
+    }
+
+    void close_group()
+    {
+        m_groups.push_back(m_group_work);
+        m_group_work = 0.0;
+    }
+
+public:
+    //! Start tracking a new timestep
+    void start_step()
+    {
+        m_segments.clear();
+        m_groups.clear();
+        m_group_work = 0.0;
+        m_start = ClockT::now();
+        m_step_start = m_start;
+        m_running = true;
+    }
+
+    //! Mark a lockstep synchronization point that is not performed
+    void skip_sync()
+    {
+        close_segment();
+        m_start = ClockT::now();
+        m_running = true;
+    }
+
+    //! Mark the start of a synchronization that is performed
+    void begin_sync()
+    {
+        close_segment();
+        close_group();
+    }
+
+    //! Mark the end of a synchronization that is performed
+    void end_sync()
+    {
+        m_start = ClockT::now();
+        m_running = true;
+    }
+
+    //! Stop tracking the current timestep
+    void end_step()
+    {
+        close_segment();
+        close_group();
+        m_step_time = TimeT(ClockT::now() - m_step_start).count();
+    }
+
+    //! Wall time of the last step in milliseconds
+    double step_time() const { return m_step_time; }
+
+    //! Segments, then groups, then the total work of the last step
+    std::vector<double> values() const
+    {
+        std::vector<double> vals(m_segments);
+        vals.insert(vals.end(), m_groups.begin(), m_groups.end());
+        vals.push_back(
+            std::accumulate(m_segments.begin(), m_segments.end(), 0.0));
+        return vals;
+    }
+
+    int num_segments() const { return static_cast<int>(m_segments.size()); }
+};
+
+//! Idle time estimates of one step whose reduction may still be in flight
+struct PendingIdle
+{
+    int step{0};
+    int num_segments{0};
+    AsyncMinAvgMax times;
+
+    //! Idle time of the lockstep loop, the loop run and the difference, and
+    //! the number of synchronizations of both. Only meaningful on the root
+    //! rank after wait()
+    std::string detail() const
+    {
+        const auto seg_begin = times.m_max.begin();
+        const auto grp_begin = seg_begin + num_segments;
+        const auto grp_end = times.m_max.end() - 1;
+        const double lockstep_path = std::accumulate(seg_begin, grp_begin, 0.0);
+        const double actual_path = std::accumulate(grp_begin, grp_end, 0.0);
+        const double work_min = times.m_min.back();
+        const double work_avg = times.m_avg.back();
+        const double work_max = times.m_max.back();
+        const double recovered = lockstep_path - actual_path;
+        // The last segment and group end with the step, not with a sync
+        const double lockstep_syncs = num_segments - 1;
+        const double syncs = (grp_end - grp_begin) - 1;
+
+        std::ostringstream outstream;
+        outstream << Timers::get_line_output(
+                         "Coupling", step, "LockstepIdle",
+                         lockstep_path - work_max, lockstep_path - work_avg,
+                         lockstep_path - work_min)
+                         .str()
+                  << std::endl
+                  << Timers::get_line_output(
+                         "Coupling", step, "Idle", actual_path - work_max,
+                         actual_path - work_avg, actual_path - work_min)
+                         .str()
+                  << std::endl
+                  << Timers::get_line_output(
+                         "Coupling", step, "IdleRecovered", recovered,
+                         recovered, recovered)
+                         .str()
+                  << std::endl
+                  << Timers::get_line_output(
+                         "Coupling", step, "LockstepSyncs", lockstep_syncs,
+                         lockstep_syncs, lockstep_syncs, 1.0)
+                         .str()
+                  << std::endl
+                  << Timers::get_line_output(
+                         "Coupling", step, "Syncs", syncs, syncs, syncs, 1.0)
+                         .str();
+        return outstream.str();
+    }
+};
+
+} // namespace exawind
+#endif /* IDLETRACKER_H */
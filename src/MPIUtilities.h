@@ -1,31 +1,144 @@
 #ifndef MPIUTILITIES_H
 #define MPIUTILITIES_H
 #include "mpi.h"
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 namespace exawind {
 
-//! Create a subcommunicator
-MPI_Comm
-create_subcomm(MPI_Comm comm, const int num_ranks, const int start_rank = 0)
+//! Placement of the solver ranks within the ranks assigned to a solver code
+enum class RankPlacement {
+    //! Consecutive ranks for each solver
+    Contiguous,
+    //! Ranks of each solver spread over the nodes
+    NodeInterleaved,
+    //! Ranks of each solver spread over the sockets
+    SocketRoundRobin,
+    //! Rank lists given in the input file
+    Explicit
+};
+
+inline RankPlacement rank_placement(const std::string& name)
+{
+    if (name == "contiguous") return RankPlacement::Contiguous;
+    if (name == "node_interleaved") return RankPlacement::NodeInterleaved;
+    if (name == "socket_round_robin") return RankPlacement::SocketRoundRobin;
+    if (name == "explicit") return RankPlacement::Explicit;
+    throw std::runtime_error(
+        "Invalid rank placement policy: " + name +
+        ". Valid options are: contiguous, node_interleaved, "
+        "socket_round_robin, explicit");
+}
+
+//! Locality domain of every rank of a communicator, identified by its lowest
+//! rank. Sockets are only distinguished with Open MPI, other implementations
+//! fall back to nodes.
+inline std::vector<int> locality_domains(MPI_Comm comm, const bool socket)
 {
-    int mpi_size;
-    MPI_Comm_size(comm, &mpi_size);
-    if ((start_rank + num_ranks) > mpi_size)
-        throw std::runtime_error(
-            "Number of MPI ranks requested is greater than available ranks: "
-            "MPI size = " +
-            std::to_string(mpi_size) +
-            "; Num ranks requested = " + std::to_string(num_ranks));
+    int split_type = MPI_COMM_TYPE_SHARED;
+#ifdef OMPI_COMM_TYPE_SOCKET
+    if (socket) split_type = OMPI_COMM_TYPE_SOCKET;
+#else
+    (void)socket;
+#endif
+    int psize, prank;
+    MPI_Comm_size(comm, &psize);
+    MPI_Comm_rank(comm, &prank);
+
+    MPI_Comm local_comm;
+    MPI_Comm_split_type(comm, split_type, prank, MPI_INFO_NULL, &local_comm);
+    int leader = prank;
+    MPI_Allreduce(MPI_IN_PLACE, &leader, 1, MPI_INT, MPI_MIN, local_comm);
+    MPI_Comm_free(&local_comm);
+
+    std::vector<int> domains(psize);
+    MPI_Allgather(&leader, 1, MPI_INT, domains.data(), 1, MPI_INT, comm);
+    return domains;
+}
 
-    MPI_Group world_group, sub_group;
-    MPI_Comm_group(comm, &world_group);
+//! Split a range of ranks starting at start_rank into groups of the given
+//! sizes. With the interleaved policies consecutive ranks of a group are
+//! taken from different locality domains in turn.
+inline std::vector<std::vector<int>> place_ranks(
+    const RankPlacement placement,
+    const std::vector<int>& domains,
+    const int start_rank,
+    const std::vector<int>& num_ranks)
+{
+    const int total = std::accumulate(num_ranks.begin(), num_ranks.end(), 0);
+    std::vector<int> ranks(total);
+    std::iota(ranks.begin(), ranks.end(), start_rank);
+
+    if ((placement == RankPlacement::NodeInterleaved) ||
+        (placement == RankPlacement::SocketRoundRobin)) {
+        std::map<int, std::vector<int>> by_domain;
+        for (const int r : ranks) by_domain[domains.at(r)].push_back(r);
+        ranks.clear();
+        for (size_t i = 0; static_cast<int>(ranks.size()) < total; ++i) {
+            for (const auto& dom : by_domain) {
+                if (i < dom.second.size()) ranks.push_back(dom.second[i]);
+            }
+        }
+    }
+
+    std::vector<std::vector<int>> groups;
+    auto first = ranks.begin();
+    for (const int nr : num_ranks) {
+        groups.emplace_back(first, first + nr);
+        std::sort(groups.back().begin(), groups.back().end());
+        first += nr;
+    }
+    return groups;
+}
+
+//! Create the communicators of disjoint groups of ranks with a single
+//! MPI_Comm_split. Returns one communicator per group, MPI_COMM_NULL for the
+//! groups this rank is not part of.
+inline std::vector<MPI_Comm>
+split_subcomms(MPI_Comm comm, const std::vector<std::vector<int>>& groups)
+{
+    int psize, prank;
+    MPI_Comm_size(comm, &psize);
+    MPI_Comm_rank(comm, &prank);
 
-    int sub_range[1][3] = {{start_rank, start_rank + num_ranks - 1, 1}};
-    MPI_Group_range_incl(world_group, 1, sub_range, &sub_group);
+    // Every rank checks the same groups, so they all agree on errors
+    std::vector<int> owner(psize, -1);
+    int color = MPI_UNDEFINED;
+    int key = 0;
+    for (int g = 0; g < static_cast<int>(groups.size()); ++g) {
+        if (groups[g].empty()) {
+            throw std::runtime_error(
+                "Solver " + std::to_string(g) + " has no MPI ranks");
+        }
+        for (int k = 0; k < static_cast<int>(groups[g].size()); ++k) {
+            const int r = groups[g][k];
+            if ((r < 0) || (r >= psize)) {
+                throw std::runtime_error(
+                    "Invalid MPI rank " + std::to_string(r) +
+                    "; MPI size = " + std::to_string(psize));
+            }
+            if (owner[r] >= 0) {
+                throw std::runtime_error(
+                    "MPI rank " + std::to_string(r) +
+                    " is assigned to more than one solver");
+            }
+            owner[r] = g;
+            if (r == prank) {
+                color = g;
+                key = k;
+            }
+        }
+    }
 
     MPI_Comm sub_comm;
-    MPI_Comm_create(comm, sub_group, &sub_comm);
-    return sub_comm;
+    MPI_Comm_split(comm, color, key, &sub_comm);
+    std::vector<MPI_Comm> comms(groups.size(), MPI_COMM_NULL);
+    if (color != MPI_UNDEFINED) comms[color] = sub_comm;
+    return comms;
 }
 
 } // namespace exawind
@@ -1,14 +1,25 @@
 #include "NaluWind.h"
 #include "NaluEnv.h"
 #include "Realm.h"
+#include "EquationSystem.h"
+#include "EquationSystems.h"
 #include "TimeIntegrator.h"
+#include "mesh_motion/MeshMotionAlg.h"
 #include "overset/ExtOverset.h"
 #include "overset/TiogaRef.h"
+#include "stk_mesh/base/BulkData.hpp"
+#include "stk_mesh/base/Field.hpp"
+#include "stk_mesh/base/MetaData.hpp"
+#include "stk_mesh/base/Selector.hpp"
 
 #include "Kokkos_Core.hpp"
 #include "tioga.h"
 #include "HypreNGP.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 namespace exawind {
 
 void NaluWind::initialize()
@@ -36,7 +47,12 @@ NaluWind::NaluWind(
     const std::string& logfile,
     const std::vector<std::string>& fnames,
     TIOGA::tioga& tg)
-    : m_doc(inp_yaml), m_sim(m_doc), m_fnames(fnames), m_id(id), m_comm(comm)
+    : m_doc(inp_yaml)
+    , m_sim(m_doc)
+    , m_fnames(fnames)
+    , m_exchange_fnames(fnames)
+    , m_id(id)
+    , m_comm(comm)
 {
     auto& env = sierra::nalu::NaluEnv::self();
     env.parallelCommunicator_ = comm;
@@ -112,6 +128,17 @@ void NaluWind::set_timestep_size(const double dt)
     m_sim.timeIntegrator_->set_time_step(dt);
 }
 
+double NaluWind::estimate_timestep_size()
+{
+    // The adaptive step is only computed by stage0, estimate it from the
+    // current CFL number instead
+    if (is_fixed_timestep_size()) return get_timestep_size();
+    double dt = 1.0e8;
+    for (auto* realm : m_sim.timeIntegrator_->realmVec_)
+        dt = std::min(dt, realm->compute_adaptive_time_step());
+    return dt;
+}
+
 bool NaluWind::is_fixed_timestep_size()
 {
     return m_sim.timeIntegrator_->get_is_fixed_time_step();
@@ -131,8 +158,50 @@ void NaluWind::additional_picard_iterations(const int n)
         realm->nonlinear_iterations(n);
 }
 
+double NaluWind::nonlinear_residual()
+{
+    double res = -1.0;
+    for (auto* realm : m_sim.timeIntegrator_->realmVec_) {
+        for (auto* eqsys : realm->equationSystems_.equationSystemVector_) {
+            res = std::max(res, eqsys->provide_scaled_norm());
+        }
+    }
+    return res;
+}
+
 void NaluWind::post_advance() { m_sim.timeIntegrator_->post_realm_advance(); }
 
+template <typename Visitor>
+void NaluWind::visit_moving_fringe_nodes(Visitor&& visit)
+{
+    for (auto* realm : m_sim.timeIntegrator_->realmVec_) {
+        if (!realm->hasOverset_ || !realm->does_mesh_move()) continue;
+
+        auto& meta = realm->meta_data();
+        auto& bulk = realm->bulk_data();
+        auto* iblank = meta.get_field<int>(stk::topology::NODE_RANK, "iblank");
+        auto* coords = meta.get_field<double>(
+            stk::topology::NODE_RANK, "current_coordinates");
+        auto* dualvol = meta.get_field<double>(
+            stk::topology::NODE_RANK, "dual_nodal_volume");
+        iblank->sync_to_host();
+        coords->sync_to_host();
+        dualvol->sync_to_host();
+        const stk::mesh::Selector sel =
+            stk::mesh::selectField(*iblank) & meta.locally_owned_part();
+        const auto& buckets = bulk.get_buckets(stk::topology::NODE_RANK, sel);
+
+        for (const auto* b : buckets) {
+            const int* ibl = stk::mesh::field_data(*iblank, *b);
+            const double* vol = stk::mesh::field_data(*dualvol, *b);
+            for (size_t in = 0; in < b->size(); ++in) {
+                if (ibl[in] != -1) continue;
+                visit(stk::mesh::field_data(*coords, (*b)[in]), vol[in]);
+            }
+        }
+    }
+}
+
 void NaluWind::pre_overset_conn_work()
 {
     m_sim.timeIntegrator_->overset_->pre_overset_conn_work();
@@ -141,11 +210,70 @@ void NaluWind::pre_overset_conn_work()
 void NaluWind::post_overset_conn_work()
 {
     m_sim.timeIntegrator_->overset_->post_overset_conn_work();
+
+    // Reference positions for the motion since this connectivity update
+    m_fringe_ref.clear();
+    visit_moving_fringe_nodes([this](const double* xyz, const double vol) {
+        m_fringe_ref.insert(m_fringe_ref.end(), xyz, xyz + 3);
+        m_fringe_ref.push_back(std::cbrt(vol));
+    });
+}
+
+double NaluWind::mesh_motion()
+{
+    if (!has_moving_mesh()) return -1.0;
+
+    double motion = 0.0;
+    size_t idx = 0;
+    bool mismatch = false;
+    visit_moving_fringe_nodes([&](const double* xyz, const double /*vol*/) {
+        if (idx + 4 > m_fringe_ref.size()) {
+            mismatch = true;
+            return;
+        }
+        const double* ref = &m_fringe_ref[idx];
+        double dist2 = 0.0;
+        for (int d = 0; d < 3; ++d) {
+            dist2 += (xyz[d] - ref[d]) * (xyz[d] - ref[d]);
+        }
+        motion = std::max(motion, std::sqrt(dist2) / ref[3]);
+        idx += 4;
+    });
+    // The fringe nodes are not the ones of the last update
+    if (mismatch || (idx != m_fringe_ref.size()))
+        return std::numeric_limits<double>::max();
+    return motion;
+}
+
+void NaluWind::predict_overset_mesh(const double time)
+{
+    // Move the mesh to the predicted position for the TIOGA registration,
+    // then back to its current position
+    const double now = get_time();
+    for (auto* realm : m_sim.timeIntegrator_->realmVec_) {
+        if (realm->meshMotionAlg_) realm->meshMotionAlg_->execute(time);
+    }
+    pre_overset_conn_work();
+    for (auto* realm : m_sim.timeIntegrator_->realmVec_) {
+        if (realm->meshMotionAlg_) realm->meshMotionAlg_->execute(now);
+    }
+}
+
+void NaluWind::select_exchange_fields(
+    const ExchangeSchedule& schedule, const bool first, const bool last)
+{
+    m_exchange_fnames.clear();
+    for (size_t i = 0; i < m_fnames.size(); ++i) {
+        if (schedule.due(static_cast<int>(i), first, last)) {
+            m_exchange_fnames.push_back(m_fnames[i]);
+        }
+    }
 }
 
 void NaluWind::register_solution()
 {
-    m_ncomps = m_sim.timeIntegrator_->overset_->register_solution(m_fnames);
+    m_ncomps =
+        m_sim.timeIntegrator_->overset_->register_solution(m_exchange_fnames);
 }
 
 void NaluWind::update_solution()
@@ -153,6 +281,33 @@ void NaluWind::update_solution()
     m_sim.timeIntegrator_->overset_->update_solution();
 }
 
+bool NaluWind::has_prescribed_motion()
+{
+    // Deforming meshes (e.g., fluid-structure interaction) depend on the
+    // solution
+    for (auto* realm : m_sim.timeIntegrator_->realmVec_) {
+        if (realm->has_mesh_deformation()) return false;
+    }
+    return true;
+}
+
+bool NaluWind::has_moving_mesh()
+{
+    for (auto* realm : m_sim.timeIntegrator_->realmVec_) {
+        if (realm->does_mesh_move()) return true;
+    }
+    return false;
+}
+
+bool NaluWind::mesh_changed()
+{
+    // The fringe nodes may stay in place while a deforming mesh changes
+    for (auto* realm : m_sim.timeIntegrator_->realmVec_) {
+        if (realm->has_mesh_deformation()) return true;
+    }
+    return mesh_motion() > 0.0;
+}
+
 int NaluWind::overset_update_interval()
 {
     for (auto& realm : m_sim.timeIntegrator_->realmVec_) {
@@ -172,4 +327,62 @@ void NaluWind::dump_simulation_time()
     }
 }
 
+template <typename Visitor>
+void NaluWind::visit_fringe_values(const bool modify, Visitor&& visit)
+{
+    for (auto* realm : m_sim.timeIntegrator_->realmVec_) {
+        if (!realm->hasOverset_) continue;
+
+        auto& meta = realm->meta_data();
+        auto& bulk = realm->bulk_data();
+        auto* iblank = meta.get_field<int>(stk::topology::NODE_RANK, "iblank");
+        iblank->sync_to_host();
+        const stk::mesh::Selector sel =
+            stk::mesh::selectField(*iblank) &
+            (meta.locally_owned_part() | meta.globally_shared_part());
+        const auto& buckets = bulk.get_buckets(stk::topology::NODE_RANK, sel);
+
+        for (const auto& fname : m_fnames) {
+            auto* fld = meta.get_field(stk::topology::NODE_RANK, fname);
+            if (fld == nullptr) {
+                throw std::runtime_error(
+                    "Unknown nalu_vars field " + fname + " in " +
+                    identifier());
+            }
+            fld->sync_to_host();
+            for (const auto* b : buckets) {
+                const int* ibl = stk::mesh::field_data(*iblank, *b);
+                for (size_t in = 0; in < b->size(); ++in) {
+                    // receptor nodes are the ones flagged as fringe
+                    if (ibl[in] != -1) continue;
+                    const auto node = (*b)[in];
+                    auto* q =
+                        static_cast<double*>(stk::mesh::field_data(*fld, node));
+                    const unsigned ncomp =
+                        stk::mesh::field_scalars_per_entity(*fld, node);
+                    for (unsigned n = 0; n < ncomp; ++n) visit(q[n]);
+                }
+            }
+            if (modify) {
+                fld->modify_on_host();
+                fld->sync_to_device();
+            }
+        }
+    }
+}
+
+void NaluWind::get_fringe_values(std::vector<double>& vals)
+{
+    vals.clear();
+    visit_fringe_values(false, [&vals](double& q) { vals.push_back(q); });
+}
+
+void NaluWind::set_fringe_values(const std::vector<double>& vals)
+{
+    size_t idx = 0;
+    visit_fringe_values(true, [&vals, &idx](double& q) {
+        if (idx < vals.size()) q = vals[idx++];
+    });
+}
+
 } // namespace exawind
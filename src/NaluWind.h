@@ -21,9 +21,23 @@ private:
     YAML::Node m_doc;
     sierra::nalu::Simulation m_sim;
     std::vector<std::string> m_fnames;
+    //! Fields registered with the next solution exchange
+    std::vector<std::string> m_exchange_fnames;
     int m_ncomps;
     int m_id;
 
+    //! Coordinates and mesh size of the fringe nodes of the moving meshes at
+    //! the last connectivity update
+    std::vector<double> m_fringe_ref;
+
+    //! Apply a visitor to the exchanged field values at the receptor nodes
+    template <typename Visitor>
+    void visit_fringe_values(const bool modify, Visitor&& visit);
+    //! Apply a visitor to the coordinates and dual volume of the owned
+    //! receptor nodes of the moving meshes
+    template <typename Visitor>
+    void visit_moving_fringe_nodes(Visitor&& visit);
+
 public:
     static void initialize();
     static void finalize();
@@ -52,13 +66,18 @@ public:
     bool is_amr() override { return false; }
     bool is_fixed_timestep_size() override;
     int overset_update_interval() override;
+    bool has_moving_mesh() override;
+    bool mesh_changed() override;
+    bool has_prescribed_motion() override;
     int time_index() override;
     std::string identifier() override
     {
         return ("Nalu-Wind-" + std::to_string(m_id));
     }
+    int instance_id() override { return m_id; }
     MPI_Comm comm() override { return m_comm; }
     int get_ncomps() override { return m_ncomps; }
+    std::vector<std::string> exchange_fields() override { return m_fnames; }
 
 protected:
     void init_prolog(bool multi_solver_mode = true) override;
@@ -71,14 +90,24 @@ protected:
     double get_time() override;
     double get_timestep_size() override;
     void set_timestep_size(const double) override;
+    double estimate_timestep_size() override;
     void advance_timestep(size_t inonlin) override;
     void additional_picard_iterations(const int) override;
     void post_advance() override;
     void pre_overset_conn_work() override;
     void post_overset_conn_work() override;
+    void predict_overset_mesh(const double time) override;
+    double mesh_motion() override;
+    void select_exchange_fields(
+        const ExchangeSchedule& schedule,
+        const bool first,
+        const bool last) override;
     void register_solution() override;
     void update_solution() override;
     void dump_simulation_time() override;
+    void get_fringe_values(std::vector<double>& vals) override;
+    void set_fringe_values(const std::vector<double>& vals) override;
+    double nonlinear_residual() override;
     MPI_Comm m_comm;
 };
 
@@ -1,17 +1,31 @@
 #include "OversetSimulation.h"
 #include "MemoryUsage.h"
 #include "Timers.h"
+#include "CollectiveBatch.h"
+#include "AutoPartition.h"
 #include <algorithm>
 #include <fstream>
+#include <limits>
 
 namespace exawind {
 
 OversetSimulation::OversetSimulation(MPI_Comm comm)
     : m_comm(comm)
+    , m_dt_batch(comm)
+    , m_iter_batch(comm)
+    , m_motion_batch(comm)
     , m_printer(comm)
     , m_timers_exa(m_names_exa)
     , m_timers_tg(m_names_tg)
 {
+    m_dt_slot = m_dt_batch.add(CollectiveBatch::Op::Min, 1e8);
+    m_drift_slot = m_iter_batch.add(CollectiveBatch::Op::Max, 0.0);
+    m_residual_slot = m_iter_batch.add(CollectiveBatch::Op::Max, -1.0);
+    m_motion_slot = m_motion_batch.add(CollectiveBatch::Op::Max, -1.0);
+    m_changed_slot = m_motion_batch.add(CollectiveBatch::Op::LogicalOr, 1.0);
+    m_preprocess_slot =
+        m_motion_batch.add(CollectiveBatch::Op::LogicalOr, 1.0);
+
     int psize, prank;
     MPI_Comm_size(m_comm, &psize);
     MPI_Comm_rank(m_comm, &prank);
@@ -19,34 +33,62 @@ OversetSimulation::OversetSimulation(MPI_Comm comm)
     m_printer.reset();
 }
 
-OversetSimulation::~OversetSimulation() = default;
+OversetSimulation::~OversetSimulation()
+{
+    int finalized;
+    MPI_Finalized(&finalized);
+    if ((m_tg_comm != MPI_COMM_NULL) && !finalized) {
+        MPI_Comm_free(&m_tg_comm);
+    }
+}
 
-void OversetSimulation::check_solver_types()
+void OversetSimulation::determine_solver_properties()
 {
-    bool flag[2] = {false, false};
-    bool gflag[2] = {false, false};
-    flag[0] =
+    // One reduction for the solver types, the overset update interval and
+    // the timestep size mode
+    CollectiveBatch batch(m_comm);
+    const int amr = batch.add(
+        CollectiveBatch::Op::LogicalOr,
         std::any_of(m_solvers.begin(), m_solvers.end(), [](const auto& ss) {
             return ss->is_amr();
-        });
-    flag[1] =
+        }));
+    const int unstructured = batch.add(
+        CollectiveBatch::Op::LogicalOr,
         std::any_of(m_solvers.begin(), m_solvers.end(), [](const auto& ss) {
             return ss->is_unstructured();
-        });
-    MPI_Allreduce(flag, gflag, 2, MPI_C_BOOL, MPI_LOR, m_comm);
-    m_has_amr = gflag[0];
-    m_has_unstructured = gflag[1];
-}
-
-void OversetSimulation::determine_overset_interval()
-{
-    int flag[1] = {m_overset_update_interval};
-    int gflag[1] = {m_overset_update_interval};
+        }));
+    int interval = m_overset_update_interval;
     for (auto& ss : m_solvers) {
-        flag[0] = std::min(flag[0], ss->overset_update_interval());
+        interval = std::min(interval, ss->overset_update_interval());
     }
-    MPI_Allreduce(flag, gflag, 1, MPI_INT, MPI_MIN, m_comm);
-    m_overset_update_interval = gflag[0];
+    const int overset_interval = batch.add(CollectiveBatch::Op::Min, interval);
+    int static_interval = m_static_update_interval;
+    for (auto& ss : m_solvers) {
+        if (ss->has_moving_mesh()) continue;
+        static_interval =
+            std::min(static_interval, ss->overset_update_interval());
+    }
+    const int static_overset_interval =
+        batch.add(CollectiveBatch::Op::Min, static_interval);
+    const int fixed_dt = batch.add(
+        CollectiveBatch::Op::LogicalAnd,
+        std::all_of(m_solvers.begin(), m_solvers.end(), [](const auto& ss) {
+            return ss->is_fixed_timestep_size();
+        }));
+    const int prescribed = batch.add(
+        CollectiveBatch::Op::LogicalAnd,
+        std::all_of(m_solvers.begin(), m_solvers.end(), [](const auto& ss) {
+            return ss->has_prescribed_motion();
+        }));
+    batch.reduce();
+
+    m_has_amr = batch.get(amr) > 0.0;
+    m_has_unstructured = batch.get(unstructured) > 0.0;
+    m_overset_update_interval = static_cast<int>(batch.get(overset_interval));
+    m_static_update_interval =
+        static_cast<int>(batch.get(static_overset_interval));
+    m_fixed_dt = batch.get(fixed_dt) > 0.0;
+    m_prescribed_motion = batch.get(prescribed) > 0.0;
     m_printer.echo(
         "Overset update interval = " +
         std::to_string(m_overset_update_interval));
@@ -54,21 +96,95 @@ void OversetSimulation::determine_overset_interval()
 
 void OversetSimulation::initialize()
 {
-    check_solver_types();
+    for (auto& ss : m_solvers) ss->call_init_prolog(true);
+
+    determine_solver_properties();
     if (!m_has_unstructured) {
         throw std::runtime_error(
             "OversetSimulationulation requires at least one unstructured "
             "solver");
     }
-
-    for (auto& ss : m_solvers) ss->call_init_prolog(true);
-
-    determine_overset_interval();
+    if ((m_num_substeps > 1) && !m_has_amr) {
+        throw std::runtime_error(
+            "Sub-cycling requires an AMR background solver");
+    }
+    if ((m_num_substeps > 1) && (m_coupling_mode != CouplingMode::Lockstep)) {
+        throw std::runtime_error(
+            "Sub-cycling is only available with lockstep coupling");
+    }
+    if ((m_num_substeps > 1) && m_adaptive_iterations) {
+        throw std::runtime_error(
+            "Adaptive iterations are not available with sub-cycling");
+    }
+    if (m_overlap_exchange) {
+        int provided;
+        MPI_Query_thread(&provided);
+        std::string reason;
+        if (provided < MPI_THREAD_MULTIPLE) {
+            reason = "MPI does not provide MPI_THREAD_MULTIPLE";
+        } else if (m_coupling_mode == CouplingMode::Lagged) {
+            reason = "lagged coupling exchanges outside of the iterations";
+        } else {
+            // Without a solver doing its stage2 work during the exchange
+            // there is nothing to hide the exchange behind
+            CollectiveBatch batch(m_comm);
+            const int any = batch.add(
+                CollectiveBatch::Op::LogicalOr,
+                std::any_of(
+                    m_solvers.begin(), m_solvers.end(), [](const auto& ss) {
+                        return ss->stage2_preserves_exchanged_fields();
+                    }));
+            batch.reduce();
+            if (batch.get(any) <= 0.0) {
+                reason = "no solver lets its stage2 work overlap the exchange";
+            }
+        }
+        if (!reason.empty()) {
+            m_printer.echo("Overlapped solution exchange disabled: " + reason);
+            m_overlap_exchange = false;
+        }
+    }
+    if (m_coupling_mode == CouplingMode::Lagged) {
+        int provided;
+        MPI_Query_thread(&provided);
+        m_lagged_overlap = provided >= MPI_THREAD_MULTIPLE;
+        if (!m_lagged_overlap) {
+            m_printer.echo(
+                "Lagged exchanges are blocking: MPI does not provide "
+                "MPI_THREAD_MULTIPLE");
+        }
+    }
+    if (m_lookahead_conn) {
+        int provided;
+        MPI_Query_thread(&provided);
+        std::string reason;
+        if (provided < MPI_THREAD_MULTIPLE) {
+            reason = "MPI does not provide MPI_THREAD_MULTIPLE";
+        } else if (!m_prescribed_motion) {
+            reason = "not all meshes have prescribed motion";
+        } else if (!m_fixed_dt) {
+            reason = "the timestep size is adaptive";
+        } else if (m_num_substeps > 1) {
+            reason = "sub-cycling is active";
+        } else if (m_motion_threshold > 0.0) {
+            reason = "connectivity updates are triggered by the mesh motion";
+        } else if (m_lagged_overlap) {
+            reason = "the lagged exchange uses the helper thread";
+        }
+        if (!reason.empty()) {
+            m_printer.echo("Look-ahead connectivity disabled: " + reason);
+            m_lookahead_conn = false;
+        }
+    }
+    // TIOGA only needs its own communicator if it runs on a helper thread
+    if (m_lookahead_conn || m_overlap_exchange || m_lagged_overlap)
+        use_tioga_comm();
 
     for (auto& ss : m_solvers) {
         ss->call_init_epilog();
         ss->call_prepare_solver_prolog();
     }
+    validate_exchange_fields();
 
     perform_overset_connectivity();
     exchange_solution();
@@ -82,21 +198,39 @@ void OversetSimulation::initialize()
     }
     m_last_timestep = m_solvers.at(0)->time_index();
 
-    // Determine if any of the solvers have adaptive timestepping
-    for (auto& ss : m_solvers) {
-        m_fixed_dt = m_fixed_dt && ss->is_fixed_timestep_size();
-    }
-    MPI_Allreduce(MPI_IN_PLACE, &m_fixed_dt, 1, MPI_C_BOOL, MPI_LAND, m_comm);
-
     m_initialized = true;
 }
 
 void OversetSimulation::perform_overset_connectivity()
 {
     for (auto& ss : m_solvers) ss->call_pre_overset_conn_work();
+    check_amr_preprocessing();
 
     m_timers_tg.tick("Connectivity");
-    if (m_has_amr) m_tg.preprocess_amr_data();
+    m_idle.begin_sync();
+    tioga_connectivity();
+    m_idle.end_sync();
+    m_timers_tg.tock("Connectivity");
+
+    finish_connectivity();
+}
+
+void OversetSimulation::check_amr_preprocessing()
+{
+    if (!m_has_amr) return;
+    // The AMR grid is only registered again with TIOGA when it has changed
+    m_motion_batch.set(
+        m_preprocess_slot,
+        std::any_of(m_solvers.begin(), m_solvers.end(), [](auto& ss) {
+            return ss->needs_amr_preprocessing();
+        }));
+    m_motion_batch.reduce();
+    m_amr_preprocess = m_motion_batch.get(m_preprocess_slot) > 0.0;
+}
+
+void OversetSimulation::tioga_connectivity()
+{
+    if (m_has_amr && m_amr_preprocess) m_tg.preprocess_amr_data();
     m_tg.profile();
     if ((m_is_adaptive_holemap_alg == 1) &&
         (m_complementary_comm_initialized == false)) {
@@ -106,29 +240,261 @@ void OversetSimulation::perform_overset_connectivity()
     }
     m_tg.performConnectivity();
     if (m_has_amr) m_tg.performConnectivityAMR();
-    m_timers_tg.tock("Connectivity");
+}
+
+void OversetSimulation::finish_connectivity()
+{
+    m_steps_since_conn = 0;
+
+    // The fringe points have changed, restart the fringe history
+    for (auto& fh : m_fringe_history) fh.clear();
+    m_full_exchanges_since_conn = 0;
+    m_all_fields_due = true;
 
     for (auto& ss : m_solvers) ss->call_post_overset_conn_work();
 }
 
-void OversetSimulation::exchange_solution(bool increment_time)
+void OversetSimulation::use_tioga_comm()
 {
+    if (m_tg_comm != MPI_COMM_NULL) return;
 
-    for (auto& ss : m_solvers) ss->call_register_solution();
+    // TIOGA collectives on a helper thread must not interleave with
+    // collectives of the driver on the same communicator
+    int psize, prank;
+    MPI_Comm_dup(m_comm, &m_tg_comm);
+    MPI_Comm_size(m_tg_comm, &psize);
+    MPI_Comm_rank(m_tg_comm, &prank);
+    m_tg.setCommunicator(m_tg_comm, prank, psize);
+}
 
+void OversetSimulation::start_lookahead_connectivity()
+{
+    // The solvers register their meshes at the next step with TIOGA. TIOGA
+    // works on copies of the coordinates and iblank arrays (Nalu-Wind copies
+    // them when registering, AMR-Wind registers copies of its iblank fields),
+    // so the solvers can finish this step and start the next one while the
+    // helper thread runs. TIOGA is not used again before the connectivity
+    // is completed.
+    for (auto& ss : m_solvers) {
+        ss->call_predict_overset_mesh(
+            ss->call_get_time() + ss->call_get_timestep_size());
+    }
+    check_amr_preprocessing();
+    m_helper.start([this]() { tioga_connectivity(); });
+    m_lookahead_pending = true;
+}
+
+void OversetSimulation::complete_lookahead_connectivity()
+{
+    // Only the part of the connectivity that did not overlap with the
+    // previous step shows up in the timers
+    m_timers_tg.tick("Connectivity");
+    m_idle.begin_sync();
+    m_helper.wait();
+    m_idle.end_sync();
+    m_timers_tg.tock("Connectivity");
+    m_lookahead_pending = false;
+
+    finish_connectivity();
+}
+
+void OversetSimulation::exchange_solution(
+    const bool increment_time, const bool first, const bool last)
+{
+    begin_exchange(increment_time, false, first, last);
+    end_exchange();
+}
+
+void OversetSimulation::begin_exchange(
+    const bool increment_time,
+    const bool overlap,
+    const bool first,
+    const bool last)
+{
+    if (skip_exchange()) {
+        m_idle.skip_sync();
+        extrapolate_fringe_values();
+        m_fringe_change = -1.0;
+        return;
+    }
+
+    // New fringe points need all fields
+    const bool all_fields = m_all_fields_due || (first && last);
+    const bool as_first = first || all_fields;
+    const bool as_last = last || all_fields;
+    if (!m_exchange_schedule.any_due(
+            m_num_exchange_fields, as_first, as_last)) {
+        m_idle.skip_sync();
+        return;
+    }
+    m_all_fields_due = false;
+    m_exchange_started = true;
+    for (auto& ss : m_solvers) {
+        ss->call_begin_exchange(m_exchange_schedule, as_first, as_last);
+    }
+
+    // The field lists are the same on all instances, so every rank
+    // registers as many components
+    if (!m_has_amr) {
+        m_exchange_ncomps = 0;
+        for (auto& ss : m_solvers) {
+            m_exchange_ncomps = std::max(m_exchange_ncomps, ss->get_ncomps());
+        }
+    }
+
+    // Only the part of an overlapped exchange that is not hidden behind the
+    // solver work shows up in the timers
     m_timers_tg.tick("SolExchange", increment_time);
+    if (overlap) {
+        m_helper.start([this]() { tioga_data_update(); });
+    } else {
+        m_idle.begin_sync();
+        tioga_data_update();
+        m_idle.end_sync();
+    }
+    m_timers_tg.tock("SolExchange");
+}
+
+void OversetSimulation::end_exchange()
+{
+    if (!m_exchange_started) return;
+    m_exchange_started = false;
+    wait_exchange();
+
+    for (auto& ss : m_solvers) ss->call_end_exchange();
+
+    if ((m_extrap_order >= 0) || m_adaptive_iterations) {
+        record_fringe_values();
+    }
+}
+
+void OversetSimulation::wait_exchange()
+{
+    if (!m_helper.pending()) return;
+    m_timers_tg.tick("SolExchange", true);
+    m_idle.begin_sync();
+    m_helper.wait();
+    m_idle.end_sync();
+    m_timers_tg.tock("SolExchange");
+}
+
+void OversetSimulation::validate_exchange_fields()
+{
+    // TIOGA matches the exchanged components by position, and the exchange
+    // schedule selects fields by position. All solvers must exchange as many
+    // fields, in the same order of quantities. The Nalu-Wind instances share
+    // the nalu_vars list.
+    const double big = std::numeric_limits<int>::max();
+    double nmin = big;
+    double nmax = 0.0;
+    for (auto& ss : m_solvers) {
+        const double nfields = ss->exchange_fields().size();
+        nmin = std::min(nmin, nfields);
+        nmax = std::max(nmax, nfields);
+    }
+    CollectiveBatch batch(m_comm);
+    const int min_slot = batch.add(CollectiveBatch::Op::Min, nmin);
+    const int max_slot = batch.add(CollectiveBatch::Op::Max, nmax);
+    batch.reduce();
+    nmin = batch.get(min_slot);
+    nmax = batch.get(max_slot);
+    if (nmin != nmax) {
+        throw std::runtime_error(
+            "The solvers exchange between " +
+            std::to_string(static_cast<int>(nmin)) + " and " +
+            std::to_string(static_cast<int>(nmax)) +
+            " fields. The overset exchange requires the same number of "
+            "fields, listed in the same order, on all meshes.");
+    }
+    m_num_exchange_fields = static_cast<int>(nmax);
+    if (m_exchange_schedule.num_positions() > m_num_exchange_fields) {
+        throw std::runtime_error(
+            "The exchange schedule refers to more fields than the " +
+            std::to_string(m_num_exchange_fields) + " exchanged ones");
+    }
+}
+
+void OversetSimulation::tioga_data_update()
+{
     if (m_has_amr) {
         m_tg.dataUpdate_AMR();
     } else {
         const int row_major = 0;
-        // assuming this pathway is nalu-wind only and all instances have same
-        // number of field components
-        const int ncomps = m_solvers[0]->get_ncomps();
-        m_tg.dataUpdate(ncomps, row_major);
+        m_tg.dataUpdate(m_exchange_ncomps, row_major);
     }
-    m_timers_tg.tock("SolExchange");
+}
+
+bool OversetSimulation::skip_exchange()
+{
+    if (m_extrap_order < 0) return false;
+    ++m_num_exchange_calls;
+    if (m_drift_pending) {
+        m_iter_batch.set(m_residual_slot, -1.0);
+        reduce_iteration_batch();
+    }
+
+    // Every rank takes the same decision, it only depends on the exchange
+    // schedule and on the globally reduced drift flag
+    const bool skip = m_initialized && !m_extrap_drift &&
+                      (m_full_exchanges_since_conn > 0) &&
+                      (m_exchanges_since_full + 1 < m_extrap_interval);
+    if (skip) {
+        ++m_exchanges_since_full;
+        ++m_num_skipped_exchanges;
+    }
+    return skip;
+}
+
+void OversetSimulation::extrapolate_fringe_values()
+{
+    std::vector<double> vals;
+    for (size_t i = 0; i < m_solvers.size(); ++i) {
+        auto& fh = m_fringe_history.at(i);
+        if (fh.num_levels() < 1) continue;
+        auto& ss = m_solvers[i];
+        fh.extrapolate(ss->call_get_time(), m_extrap_order, vals);
+        ss->call_set_fringe_values(vals);
+    }
+}
+
+void OversetSimulation::reduce_iteration_batch()
+{
+    if (!m_drift_pending) m_iter_batch.set(m_drift_slot, 0.0);
+    m_iter_batch.reduce();
+    if (!m_drift_pending) return;
+    m_drift_pending = false;
+    const double drift = m_iter_batch.get(m_drift_slot);
+    m_fringe_change = m_drift_in_step ? drift : -1.0;
+    m_extrap_drift = (m_extrap_order >= 0) && (drift > m_extrap_tol);
+}
+
+void OversetSimulation::record_fringe_values()
+{
+    m_fringe_history.resize(m_solvers.size());
 
-    for (auto& ss : m_solvers) ss->call_update_solution();
+    // The latest history level is the previous exchange. Within a step it is
+    // at the same time and the prediction error is the change between
+    // iterations. For the first exchange of a step it is at the previous
+    // step, the error only measures the extrapolation.
+    const int order = std::max(m_extrap_order, 0);
+    double drift = 0.0;
+    for (size_t i = 0; i < m_solvers.size(); ++i) {
+        auto& ss = m_solvers[i];
+        auto& fh = m_fringe_history[i];
+        std::vector<double> vals;
+        ss->call_get_fringe_values(vals);
+        const double time = ss->call_get_time();
+        drift = std::max(drift, fh.prediction_error(time, order, vals));
+        fh.push(time, std::move(vals));
+    }
+    // The drift is only needed by the next convergence check or the next
+    // extrapolation decision, it is reduced with the first of them
+    m_iter_batch.set(m_drift_slot, drift);
+    m_drift_pending = true;
+    m_drift_in_step = m_step_exchanged;
+    m_step_exchanged = true;
+    m_exchanges_since_full = 0;
+    ++m_full_exchanges_since_conn;
 }
 
 void OversetSimulation::run_timesteps(
@@ -148,6 +514,8 @@ void OversetSimulation::run_timesteps(
         "Running " + std::to_string(nsteps) + " timesteps starting from " +
         std::to_string(tstart));
 
+    setup_iteration_budgets(add_pic_its, nonlinear_its);
+
     int nt = tstart;
     double time = max_time < 0. ? 0. : m_solvers[0]->call_get_time();
     bool step_check = nsteps > 0 ? nt < tend : true;
@@ -157,68 +525,530 @@ void OversetSimulation::run_timesteps(
         m_printer.echo_time_header();
 
         m_timers_exa.tick("TimeStep");
+        m_idle.start_step();
+        m_step_exchanged = false;
+        for (auto& ss : m_solvers) ss->reset_step_timers();
+        ++m_steps_since_conn;
 
-        for (size_t inonlin = 0; inonlin < static_cast<size_t>(nonlinear_its);
-             inonlin++) {
+        const bool last_step = (nsteps > 0) && (nt + 1 >= tend);
+        m_lookahead_next =
+            m_lookahead_conn && !last_step && do_connectivity(nt + 1);
+
+        if (m_num_substeps > 1) {
+            advance_subcycled_step(nt, add_pic_its, nonlinear_its);
+        } else {
+            advance_step(nt, add_pic_its, nonlinear_its);
+        }
+
+        m_idle.end_step();
+        m_timers_exa.tock("TimeStep");
 
-            bool increment_timer = inonlin > 0 ? true : false;
+        report_step(nt);
+        autotune_step();
 
-            double dt{1e8};
+        ++nt;
+        if (max_time > 0.) time = m_solvers[0]->call_get_time();
+        step_check = nsteps > 0 ? nt < tend : true;
+        time_check = max_time > 0. ? time < max_time : true;
+        do_step = step_check && time_check &&
+                  !(m_autotune_stop && m_autotune_done);
+    }
+    finish_reports();
+    // The lagged exchange of the last step completes before the call returns.
+    // A look-ahead connectivity started during the last step is swapped in at
+    // the start of the next call.
+    end_exchange();
+    m_helper.wait();
+    if (m_num_conn_checks > 0) {
+        m_printer.echo(
+            "Skipped " + std::to_string(m_num_conn_skipped) + " of " +
+            std::to_string(m_num_conn_checks) + " connectivity updates");
+    }
+    if (m_extrap_order >= 0) {
+        m_printer.echo(
+            "Fringe extrapolation replaced " +
+            std::to_string(m_num_skipped_exchanges) + " of " +
+            std::to_string(m_num_exchange_calls) + " solution exchanges");
+    }
+    for (auto& ss : m_solvers) ss->call_dump_simulation_time();
+    m_last_timestep = tend;
+}
+
+void OversetSimulation::setup_iteration_budgets(
+    const int add_pic_its, const int nonlinear_its)
+{
+    int max_nonlin = 0;
+    int max_picard = 0;
+    for (auto& ss : m_solvers) {
+        max_nonlin =
+            std::max(max_nonlin, ss->nonlinear_iterations(nonlinear_its));
+        max_picard = std::max(max_picard, ss->picard_iterations(add_pic_its));
+    }
+    CollectiveBatch max_batch(m_comm);
+    const int nonlin_slot = max_batch.add(CollectiveBatch::Op::Max, max_nonlin);
+    const int picard_slot = max_batch.add(CollectiveBatch::Op::Max, max_picard);
+    max_batch.reduce();
+    max_nonlin = static_cast<int>(max_batch.get(nonlin_slot));
+    m_max_picard_its = static_cast<int>(max_batch.get(picard_slot));
+
+    // Each solver is counted once, by the root rank of its communicator
+    std::vector<int> active(max_nonlin, 0);
+    for (auto& ss : m_solvers) {
+        int rank;
+        MPI_Comm_rank(ss->comm(), &rank);
+        if (rank != 0) continue;
+        const int nits = ss->nonlinear_iterations(nonlinear_its);
+        for (int k = 0; k < nits; ++k) ++active[k];
+    }
+    CollectiveBatch sum_batch(m_comm);
+    for (int k = 0; k < max_nonlin; ++k) {
+        sum_batch.add(CollectiveBatch::Op::Sum, active[k]);
+    }
+    sum_batch.reduce();
+    m_nonlinear_active.resize(max_nonlin);
+    for (int k = 0; k < max_nonlin; ++k) {
+        m_nonlinear_active[k] = static_cast<int>(sum_batch.get(k));
+    }
+}
+
+bool OversetSimulation::exchange_needed(const size_t inonlin) const
+{
+    // A solver still iterating only gets new donor data from another solver
+    // that did the previous iteration
+    if (inonlin < 1) return true;
+    return (m_nonlinear_active[inonlin - 1] > 1) &&
+           (m_nonlinear_active[inonlin] > 0);
+}
+
+void OversetSimulation::advance_step(
+    const int nt, const int add_pic_its, const int nonlinear_its)
+{
+    // Each solver phase reads and writes the solver state (named after the
+    // solver). Stage0 also provides the solver dt, and stage1 the mesh
+    // position for connectivity. Exchanges read and write all solver states.
+    const bool lagged = (m_coupling_mode == CouplingMode::Lagged);
+    const int nsolvers = static_cast<int>(m_solvers.size());
+    std::vector<std::string> ids, dt_ids, mesh_ids;
+    for (auto& ss : m_solvers) {
+        ids.push_back(ss->identifier());
+        dt_ids.push_back(ss->identifier() + ":dt");
+        mesh_ids.push_back(ss->identifier() + ":mesh");
+    }
+    std::vector<double> dts(nsolvers, 1e8);
+    double dt{1e8};
+    // The meshes do not move between the iterations of a step with a
+    // look-ahead connectivity (prescribed motion)
+    const bool use_lookahead = m_lookahead_pending;
+    // The lagged exchange of the previous step overlaps the stage0 and
+    // stage1 work, unless the connectivity or the AMR grids change in this
+    // step. Both need TIOGA and the arrays the exchange writes into.
+    const bool lagged_pending = m_exchange_started;
+    const bool end_lagged_first = lagged_pending && do_connectivity(nt);
+    if (end_lagged_first) {
+        m_scheduler.add_collective(
+            "Exawind::EndExchange", ids, ids, [this]() { end_exchange(); });
+    }
+
+    // Fields with an exchange schedule only go with the first or the last
+    // exchange of the step
+    bool first_exchange = true;
+    auto add_exchange = [&](const bool increment_time, const bool last) {
+        const bool first = first_exchange;
+        first_exchange = false;
+        m_scheduler.add_collective(
+            "Exawind::SolExchange", ids, ids,
+            [this, increment_time, first, last]() {
+                exchange_solution(increment_time, first, last);
+            });
+    };
+    // The stage2 work of the solvers that do not modify the exchanged
+    // fields runs between the two halves of an overlapped exchange
+    auto add_begin_exchange = [&](const bool increment_time, const bool last) {
+        const bool first = first_exchange;
+        first_exchange = false;
+        m_scheduler.add_collective(
+            "Exawind::BeginExchange", ids, {"exchange"},
+            [this, increment_time, first, last]() {
+                begin_exchange(increment_time, true, first, last);
+            });
+    };
+    // TIOGA is not used again in a step after its last exchange, so the
+    // look-ahead connectivity for the next step starts there and overlaps
+    // the remaining solves. The meshes at the next step are registered with
+    // TIOGA before the solvers go on.
+    bool lookahead_started = false;
+    auto add_lookahead = [&]() {
+        if (!m_lookahead_next || lookahead_started) return;
+        lookahead_started = true;
+        m_scheduler.add_collective(
+            "Exawind::LookaheadConnectivity", ids, {},
+            [this]() { start_lookahead_connectivity(); });
+    };
+    auto add_end_exchange = [&]() {
+        m_scheduler.add_collective(
+            "Exawind::EndExchange", {"exchange"}, ids,
+            [this]() { end_exchange(); });
+    };
+    // Marks where lockstep coupling would exchange
+    auto add_skipped_exchange = [&]() {
+        m_scheduler.add_collective(
+            "Exawind::SkippedExchange", ids, ids,
+            [this]() {
+                m_idle.skip_sync();
+                m_fringe_change = -1.0;
+                m_drift_in_step = false;
+            });
+    };
+
+    // With adaptive iterations the graph is run one iteration at a time, the
+    // convergence check after each solve decides whether to continue
+    // Solvers that have used their iteration budget drop out of the remaining
+    // iterations and of the exchanges only they would need
+    bool converged = false;
+    int nonlinear_its_used = 0;
+    const size_t max_nonlinear_its = m_nonlinear_active.size();
+    for (size_t inonlin = 0; inonlin < max_nonlinear_its; inonlin++) {
+
+        bool increment_timer = inonlin > 0 ? true : false;
+        const bool reduce_dt = (inonlin < 1) && !m_fixed_dt;
+        const bool check = m_adaptive_iterations && (inonlin > 0);
+        // The fringe values only change between iterations from the second
+        // exchange of the step on
+        if (check) {
+            converged = check_convergence(inonlin > 1);
+            if (converged) break;
+        }
+        std::vector<bool> active(nsolvers);
+        for (int i = 0; i < nsolvers; ++i) {
+            active[i] = static_cast<int>(inonlin) <
+                        m_solvers[i]->nonlinear_iterations(nonlinear_its);
+        }
+
+        for (int i = 0; i < nsolvers; ++i) {
+            auto* ss = m_solvers[i].get();
+            if (!active[i]) continue;
+            m_scheduler.add_task(
+                ids[i] + "::Stage0", {ids[i]}, {ids[i], dt_ids[i]},
+                [ss, inonlin, reduce_dt, &dts, i]() {
+                    ss->call_pre_advance_stage0(inonlin);
+                    if (reduce_dt) dts[i] = ss->call_get_timestep_size();
+                });
+        }
+
+        if (reduce_dt) {
+            m_scheduler.add_collective(
+                "Exawind::DtReduction", dt_ids, {"dt"}, [this, &dts, &dt]() {
+                    for (const auto sdt : dts) dt = std::min(dt, sdt);
+                    m_dt_batch.set(m_dt_slot, dt);
+                    m_idle.begin_sync();
+                    m_dt_batch.reduce();
+                    m_idle.end_sync();
+                    dt = m_dt_batch.get(m_dt_slot);
+                });
+            for (int i = 0; i < nsolvers; ++i) {
+                auto* ss = m_solvers[i].get();
+                m_scheduler.add_task(
+                    ids[i] + "::SetDt", {"dt", ids[i]}, {ids[i]},
+                    [ss, &dt]() { ss->call_set_timestep_size(dt); });
+            }
+        }
+
+        for (int i = 0; i < nsolvers; ++i) {
+            auto* ss = m_solvers[i].get();
+            if (!active[i]) continue;
+            m_scheduler.add_task(
+                ids[i] + "::Stage1", {ids[i]}, {ids[i], mesh_ids[i]},
+                [ss, inonlin]() { ss->call_pre_advance_stage1(inonlin); });
+        }
+        if (lagged_pending && !end_lagged_first && (inonlin < 1)) {
+            m_scheduler.add_collective(
+                "Exawind::EndExchange", mesh_ids, ids,
+                [this]() { end_exchange(); });
+        }
+
+        // New fringe points have no data, so even in lagged mode the
+        // solution has to be exchanged after a connectivity update. Whether
+        // the mesh moved enough for an update is only known after stage1.
+        const bool new_connectivity = do_connectivity(nt);
+        if (new_connectivity) {
+            m_scheduler.add_collective(
+                "Exawind::Connectivity", mesh_ids, {"connectivity"},
+                [this, use_lookahead, inonlin, nt, lagged, increment_timer]() {
+                    if (use_lookahead) {
+                        if (inonlin < 1) complete_lookahead_connectivity();
+                        return;
+                    }
+                    if (!connectivity_due(nt)) {
+                        if (lagged) m_idle.skip_sync();
+                        return;
+                    }
+                    perform_overset_connectivity();
+                    if (lagged) exchange_solution(increment_timer);
+                });
+        }
+
+        const bool exchange =
+            !lagged && (exchange_needed(inonlin) || new_connectivity);
+        const bool overlap = exchange && m_overlap_exchange;
+        const bool last_exchange =
+            (inonlin + 1 == max_nonlinear_its) && (m_max_picard_its == 0);
+        auto add_stage2 = [&](const bool overlapped) {
+            for (int i = 0; i < nsolvers; ++i) {
+                auto* ss = m_solvers[i].get();
+                if (!active[i]) continue;
+                if (overlap &&
+                    (ss->stage2_preserves_exchanged_fields() != overlapped))
+                    continue;
+                m_scheduler.add_task(
+                    ids[i] + "::Stage2", {ids[i], "connectivity"}, {ids[i]},
+                    [ss, inonlin]() { ss->call_pre_advance_stage2(inonlin); });
+            }
+        };
+
+        add_stage2(false);
+        if (overlap) {
+            add_begin_exchange(increment_timer, last_exchange);
+            add_stage2(true);
+            add_end_exchange();
+        } else if (exchange) {
+            add_exchange(increment_timer, last_exchange);
+        } else if (!lagged || !new_connectivity) {
+            add_skipped_exchange();
+        }
+        if ((inonlin + 1 == max_nonlinear_its) && (m_max_picard_its == 0)) {
+            add_lookahead();
+        }
+
+        for (int i = 0; i < nsolvers; ++i) {
+            auto* ss = m_solvers[i].get();
+            if (!active[i]) continue;
+            m_scheduler.add_task(
+                ids[i] + "::Solve", {ids[i]}, {ids[i]},
+                [ss, inonlin, increment_timer]() {
+                    ss->call_advance_timestep(inonlin, increment_timer);
+                });
+        }
+
+        if (m_adaptive_iterations) m_scheduler.run();
+        ++nonlinear_its_used;
+    }
+
+    // The last nonlinear iteration is checked before the Picard exchange
+    if ((m_max_picard_its > 0) && m_adaptive_iterations && !converged) {
+        converged = check_convergence(true);
+    }
+    int picard_its_used = 0;
+    if ((m_max_picard_its > 0) && !converged) {
+        if (!lagged) {
+            add_exchange(true, true);
+        } else {
+            add_skipped_exchange();
+        }
+        add_lookahead();
+        if (m_adaptive_iterations) m_scheduler.run();
+
+        // Picard iterations are run one at a time while the solver residuals
+        // say more are needed
+        const int npasses = m_adaptive_iterations ? m_max_picard_its : 1;
+        bool has_residual = true;
+        for (int ipass = 0; (ipass < npasses) && !converged && has_residual;
+             ++ipass) {
+            for (int i = 0; i < nsolvers; ++i) {
+                auto* ss = m_solvers[i].get();
+                const int pic_its = ss->picard_iterations(add_pic_its);
+                const int nits = m_adaptive_iterations ? 1 : pic_its;
+                if (pic_its <= ipass) continue;
+                m_scheduler.add_task(
+                    ids[i] + "::AdditionalPicardIterations", {ids[i]},
+                    {ids[i]}, [ss, nits, ipass]() {
+                        ss->call_additional_picard_iterations(nits, ipass > 0);
+                    });
+            }
+            picard_its_used += m_adaptive_iterations ? 1 : m_max_picard_its;
+            if (m_adaptive_iterations) {
+                m_scheduler.run();
+                converged = check_convergence(false);
+                has_residual = m_residual_available;
+            }
+        }
+        if (m_adaptive_iterations && !has_residual && !converged) {
+            // Without residuals there is nothing to adapt to, finish the passes
             for (auto& ss : m_solvers) {
-                ss->call_pre_advance_stage0(inonlin, increment_timer);
-                if (inonlin < 1 && !m_fixed_dt) {
-                    dt = std::min(dt, ss->call_get_timestep_size());
-                }
+                const int nits =
+                    ss->picard_iterations(add_pic_its) - picard_its_used;
+                if (nits > 0) ss->call_additional_picard_iterations(nits, true);
             }
+            picard_its_used = m_max_picard_its;
+        }
+    }
+    m_iteration_counts = {nonlinear_its_used, picard_its_used};
+
+    for (int i = 0; i < nsolvers; ++i) {
+        auto* ss = m_solvers[i].get();
+        m_scheduler.add_task(
+            ids[i] + "::Post", {ids[i]}, {ids[i]},
+            [ss]() { ss->call_post_advance(); });
+    }
 
-            if (inonlin < 1 && !m_fixed_dt) {
-                MPI_Allreduce(
-                    MPI_IN_PLACE, &dt, 1, MPI_DOUBLE, MPI_MIN, m_comm);
-                for (auto& ss : m_solvers) ss->call_set_timestep_size(dt);
+    // Fringe data for the next step
+    if (lagged && m_lagged_overlap) {
+        add_begin_exchange(true, true);
+    } else if (lagged) {
+        add_exchange(true, true);
+    }
+
+    // Iterations that stopped on convergence skipped the last exchange
+    add_lookahead();
+
+    m_scheduler.run();
+}
+
+void OversetSimulation::advance_subcycled_step(
+    const int nt, const int add_pic_its, const int nonlinear_its)
+{
+    // Background solver: one coarse step using the near-body solution at the
+    // start of the step. Its solution does not change during the pass, so one
+    // exchange is enough for all nonlinear iterations.
+    // Connectivity is collective, so the iteration loops run up to the largest
+    // iteration budget and skip the solvers that are done.
+    double dt{1e8};
+    const size_t max_nonlinear_its = m_nonlinear_active.size();
+    auto active = [nonlinear_its](ExawindSolver* ss, const size_t inonlin) {
+        return static_cast<int>(inonlin) <
+               ss->nonlinear_iterations(nonlinear_its);
+    };
+    for (size_t inonlin = 0; inonlin < max_nonlinear_its; inonlin++) {
+
+        bool increment_timer = inonlin > 0 ? true : false;
+
+        for (auto& ss : m_solvers) {
+            if (!ss->is_amr() || !active(ss.get(), inonlin)) continue;
+            ss->call_pre_advance_stage0(inonlin);
+            if (inonlin < 1) dt = std::min(dt, ss->call_get_timestep_size());
+        }
+
+        if (inonlin < 1) {
+            // The sub-steps overwrite the dt the near-body solvers compute in
+            // stage0, so their CFL limit is estimated before the reduction
+            for (auto& ss : m_solvers) {
+                if (ss->is_amr()) continue;
+                dt = std::min(
+                    dt, m_num_substeps * ss->call_estimate_timestep_size());
+            }
+            m_dt_batch.set(m_dt_slot, dt);
+            m_idle.begin_sync();
+            m_dt_batch.reduce();
+            m_idle.end_sync();
+            dt = m_dt_batch.get(m_dt_slot);
+            for (auto& ss : m_solvers) {
+                if (ss->is_amr()) ss->call_set_timestep_size(dt);
             }
+        }
 
-            for (auto& ss : m_solvers)
-                ss->call_pre_advance_stage1(inonlin, increment_timer);
+        for (auto& ss : m_solvers) {
+            if (ss->is_amr() && active(ss.get(), inonlin))
+                ss->call_pre_advance_stage1(inonlin);
+        }
 
-            if (do_connectivity(nt)) perform_overset_connectivity();
+        if (connectivity_due(nt)) perform_overset_connectivity();
 
-            for (auto& ss : m_solvers)
-                ss->call_pre_advance_stage2(inonlin, increment_timer);
+        for (auto& ss : m_solvers) {
+            if (ss->is_amr() && active(ss.get(), inonlin))
+                ss->call_pre_advance_stage2(inonlin);
+        }
 
-            exchange_solution(increment_timer);
+        if (inonlin < 1) exchange_solution(increment_timer);
 
-            for (auto& ss : m_solvers)
+        for (auto& ss : m_solvers) {
+            if (ss->is_amr() && active(ss.get(), inonlin))
                 ss->call_advance_timestep(inonlin, increment_timer);
         }
+    }
 
-        if (add_pic_its > 0) {
-            exchange_solution(true);
-            for (auto& ss : m_solvers)
-                ss->call_additional_picard_iterations(add_pic_its);
+    // Near-body solvers: sub-steps with the background donor data
+    // interpolated in time between the start and the end of the coarse step
+    const double dt_sub = dt / m_num_substeps;
+    for (int isub = 1; isub <= m_num_substeps; ++isub) {
+        const double frac = static_cast<double>(isub) / m_num_substeps;
+        for (auto& ss : m_solvers) {
+            if (ss->is_amr()) ss->call_set_exchange_time_fraction(frac);
         }
 
-        for (auto& ss : m_solvers) ss->call_post_advance();
+        for (size_t inonlin = 0; inonlin < max_nonlinear_its; inonlin++) {
 
-        MPI_Barrier(m_comm);
+            bool increment_timer = (inonlin > 0) || (isub > 1);
 
-        m_timers_exa.tock("TimeStep");
+            for (auto& ss : m_solvers) {
+                if (ss->is_amr() || !active(ss.get(), inonlin)) continue;
+                ss->call_pre_advance_stage0(inonlin);
+                if (inonlin < 1) ss->call_set_timestep_size(dt_sub);
+            }
 
-        MPI_Barrier(m_comm);
+            for (auto& ss : m_solvers) {
+                if (!ss->is_amr() && active(ss.get(), inonlin))
+                    ss->call_pre_advance_stage1(inonlin);
+            }
 
-        print_timing(nt);
+            if (connectivity_due(nt)) perform_overset_connectivity();
 
-        MPI_Barrier(m_comm);
+            for (auto& ss : m_solvers) {
+                if (!ss->is_amr() && active(ss.get(), inonlin))
+                    ss->call_pre_advance_stage2(inonlin);
+            }
 
-        mem_usage_all(nt);
+            exchange_solution(true);
 
-        ++nt;
-        if (max_time > 0.) time = m_solvers[0]->call_get_time();
-        step_check = nsteps > 0 ? nt < tend : true;
-        time_check = max_time > 0. ? time < max_time : true;
-        do_step = step_check && time_check;
+            for (auto& ss : m_solvers) {
+                if (!ss->is_amr() && active(ss.get(), inonlin))
+                    ss->call_advance_timestep(inonlin, increment_timer);
+            }
+        }
+
+        if (m_max_picard_its > 0) {
+            exchange_solution(true);
+            for (auto& ss : m_solvers) {
+                const int pic_its = ss->picard_iterations(add_pic_its);
+                if (!ss->is_amr() && (pic_its > 0))
+                    ss->call_additional_picard_iterations(pic_its);
+            }
+        }
+
+        for (auto& ss : m_solvers) {
+            if (!ss->is_amr()) ss->call_post_advance();
+        }
+    }
+
+    for (auto& ss : m_solvers) {
+        if (ss->is_amr()) ss->call_post_advance();
     }
-    for (auto& ss : m_solvers) ss->call_dump_simulation_time();
-    m_last_timestep = tend;
+}
+
+double OversetSimulation::local_residual()
+{
+    double res = -1.0;
+    for (auto& ss : m_solvers) {
+        res = std::max(res, ss->call_nonlinear_residual());
+    }
+    return res;
+}
+
+bool OversetSimulation::check_convergence(const bool use_fringe)
+{
+    // The residuals of the last solve, the fringe change is the one of the
+    // exchange before that solve
+    m_iter_batch.set(m_residual_slot, local_residual());
+    reduce_iteration_batch();
+    const double res = m_iter_batch.get(m_residual_slot);
+
+    // Residuals are negative when no solver provides them, fringe changes
+    // when the last exchange was not a full exchange
+    const bool has_res = res >= 0.0;
+    m_residual_available = has_res;
+    const bool has_fringe = use_fringe && (m_fringe_change >= 0.0);
+    if (!has_res && !has_fringe) return false;
+    const bool res_ok = !has_res || (res <= m_residual_tol);
+    const bool fringe_ok = !has_fringe || (m_fringe_change <= m_fringe_tol);
+    return res_ok && fringe_ok;
 }
 
 bool OversetSimulation::do_connectivity(const int tstep)
@@ -226,81 +1056,297 @@ bool OversetSimulation::do_connectivity(const int tstep)
     return (tstep > 0) && (tstep % m_overset_update_interval) == 0;
 }
 
-void OversetSimulation::print_timing(const int nt)
+bool OversetSimulation::connectivity_due(const int tstep)
 {
-    // overall timestep timing
-    auto timing_summary = m_timers_exa.get_timings_summary(
-        "Exawind", nt, m_comm, m_printer.io_rank());
-    m_printer.echo(timing_summary);
+    if (!do_connectivity(tstep)) return false;
+    // Decided at the first check of a step, the other iterations and the
+    // sub-steps follow that decision
+    if (tstep == m_conn_decision_step) return m_conn_decision;
+    const bool motion_trigger = m_motion_threshold > 0.0;
+    // Regridding only changes the AMR connectivity if the grid hierarchy
+    // has changed, incremental updates are skipped unless a mesh has changed
+    const bool check_changes = m_incremental_conn;
+    if (!motion_trigger && !check_changes) return true;
+    ++m_num_conn_checks;
 
-    auto timing_detail = m_timers_exa.get_timings_detail(
-        "Exawind", nt, m_comm, m_printer.io_rank());
-    m_printer.timing_to_file(timing_detail);
+    double motion = -1.0;
+    bool changed = true;
+    if (motion_trigger) {
+        for (auto& ss : m_solvers) {
+            motion = std::max(motion, ss->call_mesh_motion());
+        }
+    }
+    if (check_changes) {
+        changed = std::any_of(
+            m_solvers.begin(), m_solvers.end(),
+            [](const auto& ss) { return ss->mesh_changed(); });
+    }
+    m_motion_batch.set(m_motion_slot, motion);
+    m_motion_batch.set(m_changed_slot, changed);
+    m_motion_batch.reduce();
 
-    MPI_Barrier(m_comm);
+    // Regridding and other updates that do not come from mesh motion are
+    // always due with the motion trigger. TIOGA redoes the connectivity of
+    // all meshes, so it can only be kept if no mesh has changed.
+    bool due = true;
+    if (motion_trigger) {
+        due = ((tstep % m_static_update_interval) == 0) ||
+              (m_steps_since_conn >= m_max_conn_interval) ||
+              (m_motion_batch.get(m_motion_slot) > m_motion_threshold);
+    }
+    if (check_changes) {
+        due = due && (m_motion_batch.get(m_changed_slot) > 0.0);
+    }
 
-    // tioga timing
-    timing_summary = m_timers_tg.get_timings_summary(
-        "Tioga", nt, m_comm, m_printer.io_rank());
-    m_printer.echo(timing_summary);
+    if (!due) ++m_num_conn_skipped;
+    m_conn_decision_step = tstep;
+    m_conn_decision = due;
+    return due;
+}
 
-    timing_detail = m_timers_tg.get_timings_detail(
-        "Tioga", nt, m_comm, m_printer.io_rank());
-    m_printer.timing_to_file(timing_detail);
+void OversetSimulation::autotune_step()
+{
+    if ((m_autotune_window < 1) || m_autotune_done) return;
+    if (++m_autotune_steps <= m_autotune_skip) return;
 
-    // cfd solver-specific timing
-    for (auto& ss : m_solvers) {
-        MPI_Barrier(m_comm);
+    // Measured at full clock resolution, the millisecond timers truncate
+    // every incremental tick
+    m_autotune_work.resize(m_solvers.size(), 0.0);
+    for (size_t i = 0; i < m_solvers.size(); ++i) {
+        m_autotune_work[i] += m_solvers[i]->step_work();
+    }
+    m_autotune_idle +=
+        std::max(0.0, m_idle.step_time() - m_idle.values().back());
 
-        ParallelPrinter printer(ss->comm());
+    if (m_autotune_steps - m_autotune_skip == m_autotune_window) {
+        finish_autotune();
+    }
+}
+
+void OversetSimulation::finish_autotune()
+{
+    m_autotune_done = true;
+
+    // Critical path and number of ranks of every solver of the simulation
+    const int nslots = m_num_nw_solvers + 1;
+    CollectiveBatch batch(m_comm);
+    std::vector<int> time_slots(nslots), rank_slots(nslots);
+    for (int s = 0; s < nslots; ++s) {
+        time_slots[s] = batch.add(CollectiveBatch::Op::Max);
+        rank_slots[s] = batch.add(CollectiveBatch::Op::Sum);
+    }
+    for (size_t i = 0; i < m_solvers.size(); ++i) {
+        const int s = m_solvers[i]->instance_id();
+        batch.set(time_slots[s], m_autotune_work[i]);
+        batch.set(rank_slots[s], 1.0);
+    }
+    const int max_idle_slot =
+        batch.add(CollectiveBatch::Op::Max, m_autotune_idle);
+    const int sum_idle_slot =
+        batch.add(CollectiveBatch::Op::Sum, m_autotune_idle);
+    batch.reduce();
 
-        // summary timings
-        std::string timings_summary = ss->m_timers.get_timings_summary(
-            ss->identifier(), nt, ss->comm(), printer.io_rank());
-        printer.echo(timings_summary);
+    int psize;
+    MPI_Comm_size(m_comm, &psize);
+    const double window = static_cast<double>(m_autotune_window);
+
+    // Assuming strong scaling within each solver, its cost is the rank time
+    // it needs per step. Solvers sharing ranks get disjoint ranks.
+    std::vector<int> ids;
+    std::vector<double> costs;
+    for (int s = 0; s < nslots; ++s) {
+        const double nranks = batch.get(rank_slots[s]);
+        if (nranks < 1.0) continue;
+        ids.push_back(s);
+        costs.push_back(batch.get(time_slots[s]) * nranks / window);
+    }
+    const auto ranks = partition_ranks(costs, psize);
+
+    std::ostringstream summary;
+    summary << "Autotuning over " << m_autotune_window << " timesteps:";
+    for (size_t k = 0; k < ids.size(); ++k) {
+        const std::string name =
+            (ids[k] == 0) ? "AMR-Wind" : "Nalu-Wind-" + std::to_string(ids[k]);
+        summary << " " << name << " "
+                << batch.get(time_slots[ids[k]]) / window << " ms/step on "
+                << batch.get(rank_slots[ids[k]]) << " ranks;";
+    }
+    summary << " idle at synchronizations " << batch.get(max_idle_slot) / window
+            << " ms/step max, "
+            << batch.get(sum_idle_slot) / (window * psize) << " ms/step avg";
+    m_printer.echo(summary.str());
 
-        // detailed timings
-        std::string timings_detail = ss->m_timers.get_timings_detail(
-            ss->identifier(), nt, ss->comm(), printer.io_rank());
-        printer.timing_to_file(timings_detail);
+    std::ostringstream recommended;
+    recommended << "Autotuning recommends:";
+    int num_awind = 0;
+    std::vector<int> nalu_procs;
+    for (size_t k = 0; k < ids.size(); ++k) {
+        if (ids[k] == 0) {
+            num_awind = ranks[k];
+            recommended << " --awind " << ranks[k];
+        } else {
+            nalu_procs.push_back(ranks[k]);
+        }
     }
+    const int num_nwind = psize - num_awind;
+    recommended << " --nwind " << num_nwind << "; nalu_wind_procs [";
+    for (size_t i = 0; i < nalu_procs.size(); ++i) {
+        recommended << (i > 0 ? ", " : "") << nalu_procs[i];
+    }
+    recommended << "]; predicted imbalance "
+                << 100.0 * predicted_imbalance(costs, ranks) << "%";
+    m_printer.echo(recommended.str());
 
-    MPI_Barrier(m_comm);
+    if (m_printer.is_io_rank() && !m_autotune_file.empty()) {
+        std::ofstream fp(m_autotune_file);
+        fp << "# Rank layout recommended by the exawind autotuner" << std::endl
+           << "# Cost per step (rank ms) measured over "
+           << m_autotune_window << " timesteps:";
+        for (const double c : costs) fp << " " << c;
+        fp << std::endl
+           << "mpi_ranks: " << psize << std::endl
+           << "awind: " << num_awind << std::endl
+           << "nwind: " << num_nwind << std::endl
+           << "nalu_wind_procs: [";
+        for (size_t i = 0; i < nalu_procs.size(); ++i) {
+            fp << (i > 0 ? ", " : "") << nalu_procs[i];
+        }
+        fp << "]" << std::endl;
+    }
 }
 
-long OversetSimulation::mem_usage_all(const int step)
+void OversetSimulation::report_step(const int nt)
 {
-    const long mem = memory_usage();
+    if ((nt % m_report_interval) != 0) {
+        // Drive the outstanding reductions without blocking
+        for (auto& pt : m_pending_timings) pt.second.times.test();
+        for (auto& pi : m_pending_idle) pi.times.test();
+        if (m_mem_request != MPI_REQUEST_NULL) {
+            int flag = 0;
+            MPI_Test(&m_mem_request, &flag, MPI_STATUS_IGNORE);
+        }
+        return;
+    }
+
+    // The previous report has had at least one timestep to complete
+    finish_reports();
+    start_reports(nt);
+}
 
+void OversetSimulation::start_reports(const int nt)
+{
+    // overall timestep timing
+    m_pending_timings.emplace_back(
+        m_printer, m_timers_exa.start_timings_reduction(
+                       "Exawind", nt, m_comm, m_printer.io_rank()));
+
+    // tioga timing
+    m_pending_timings.emplace_back(
+        m_printer, m_timers_tg.start_timings_reduction(
+                       "Tioga", nt, m_comm, m_printer.io_rank()));
+
+    // cfd solver-specific timing
+    for (auto& ss : m_solvers) {
+        ParallelPrinter printer(ss->comm());
+        m_pending_timings.emplace_back(
+            printer, ss->m_timers.start_timings_reduction(
+                         ss->identifier(), nt, ss->comm(), printer.io_rank()));
+    }
+
+    // idle time at synchronization points
+    PendingIdle idle;
+    idle.step = nt;
+    idle.num_segments = m_idle.num_segments();
+    idle.times.start(m_idle.values(), m_comm, m_printer.io_rank());
+    m_pending_idle.push_back(std::move(idle));
+
+    // iteration counts, identical on all ranks
+    if (m_adaptive_iterations) {
+        std::ostringstream out;
+        out << Timers::get_line_output(
+                   "Exawind", nt, "NonlinearIterations", m_iteration_counts[0],
+                   m_iteration_counts[0], m_iteration_counts[0], 1.0)
+                   .str()
+            << std::endl
+            << Timers::get_line_output(
+                   "Exawind", nt, "PicardIterations", m_iteration_counts[1],
+                   m_iteration_counts[1], m_iteration_counts[1], 1.0)
+                   .str();
+        m_pending_lines.push_back(out.str());
+    }
+
+    // connectivity updates skipped so far, identical on all ranks
+    if (m_num_conn_checks > 0) {
+        const double nskip = static_cast<double>(m_num_conn_skipped);
+        const double ncheck = static_cast<double>(m_num_conn_checks);
+        std::ostringstream out;
+        out << Timers::get_line_output(
+                   "Exawind", nt, "ConnectivityChecks", ncheck, ncheck, ncheck,
+                   1.0)
+                   .str()
+            << std::endl
+            << Timers::get_line_output(
+                   "Exawind", nt, "ConnectivitySkipped", nskip, nskip, nskip,
+                   1.0)
+                   .str();
+        m_pending_lines.push_back(out.str());
+    }
+
+    // memory usage
     int psize;
     MPI_Comm_size(m_comm, &psize);
+    m_mem = memory_usage();
+    m_mem_step = nt;
+    m_memall.resize(psize);
+    MPI_Igather(
+        &m_mem, 1, MPI_LONG, m_memall.data(), 1, MPI_LONG, m_printer.io_rank(),
+        m_comm, &m_mem_request);
+}
+
+void OversetSimulation::finish_reports()
+{
+    for (auto& pt : m_pending_timings) {
+        auto& printer = pt.first;
+        auto& timings = pt.second;
+        timings.times.wait();
+        printer.echo(timings.summary());
+        printer.timing_to_file(timings.detail());
+    }
+    m_pending_timings.clear();
+
+    for (auto& pi : m_pending_idle) {
+        pi.times.wait();
+        m_printer.timing_to_file(pi.detail());
+    }
+    m_pending_idle.clear();
+
+    for (const auto& line : m_pending_lines) m_printer.timing_to_file(line);
+    m_pending_lines.clear();
 
-    // gather all memory usage
-    std::vector<long> memall(psize);
-    MPI_Gather(
-        &mem, 1, MPI_LONG, memall.data(), 1, MPI_LONG, m_printer.io_rank(),
-        m_comm);
+    if (m_mem_step < 0) return;
+    MPI_Wait(&m_mem_request, MPI_STATUS_IGNORE);
 
     // FIXME: move to separate output files and put in ExawindSolver
     if (m_printer.is_io_rank()) {
         const std::string filename = "memusage.dat";
         std::ofstream fp;
 
-        if (step == m_last_timestep + 1) {
+        if (!m_memfile_initialized) {
             fp.open(filename.c_str(), std::ios_base::out);
             fp << "# time step, memory usage in MBs" << std::endl;
         } else {
             fp.open(filename.c_str(), std::ios_base::app);
         }
 
-        fp << std::to_string(step);
-        for (const auto& m : memall) {
+        fp << std::to_string(m_mem_step);
+        for (const auto& m : m_memall) {
             fp << ' ' << m;
         }
         fp << std::endl;
         fp.close();
     }
-    return mem;
+    m_memfile_initialized = true;
+    m_mem_step = -1;
 }
 
 } // namespace exawind
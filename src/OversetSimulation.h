@@ -5,6 +5,12 @@
 #include "ExawindSolver.h"
 #include "ParallelPrinter.h"
 #include "Timers.h"
+#include "IdleTracker.h"
+#include "FringeHistory.h"
+#include "PhaseScheduler.h"
+#include "CollectiveBatch.h"
+#include "ExchangeSchedule.h"
+#include "HelperThread.h"
 
 namespace TIOGA {
 class tioga;
@@ -12,11 +18,31 @@ class tioga;
 
 namespace exawind {
 
+//! Coupling strategy between the solvers during a timestep
+enum class CouplingMode {
+    //! Exchange before every nonlinear and Picard iteration
+    Lockstep,
+    //! Exchange once at the end of the step (and after connectivity updates);
+    //! iterations within the step use the fringe data of the previous step.
+    //! The end of step exchange runs on a helper thread and completes before
+    //! the stage2 work of the next step, or at the start of the next step if
+    //! that step updates the connectivity (which also regrids AMR).
+    Lagged
+};
+
 class OversetSimulation
 {
 private:
     //! World communicator instance
     MPI_Comm m_comm;
+    //! Batched reduction of the timestep size
+    CollectiveBatch m_dt_batch;
+    int m_dt_slot{-1};
+    //! Batched reduction of the fringe change of the last full exchange and
+    //! of the solver residuals after the following solve
+    CollectiveBatch m_iter_batch;
+    int m_drift_slot{-1};
+    int m_residual_slot{-1};
     //! List of solvers active in this overset simulation
     std::vector<std::unique_ptr<ExawindSolver>> m_solvers;
     //! List of start ranks for all nalu-wind instances
@@ -24,6 +50,8 @@ private:
     std::vector<int> m_nw_start_rank;
     //! Flag indicating whether an AMR solver is active
     bool m_has_amr{false};
+    //! Flag indicating whether TIOGA has to preprocess the AMR grid
+    bool m_amr_preprocess{true};
     //! Flag indicating whether an unstructured solver is active
     bool m_has_unstructured{false};
     //! Interval for overset updates during timestepping
@@ -33,6 +61,8 @@ private:
     //! Flag indicating whether all solvers use fixed dt. If any solver uses
     //! adaptive dt, then this flag will be false
     bool m_fixed_dt{true};
+    //! Flag indicating whether all meshes have prescribed motion (or none)
+    bool m_prescribed_motion{false};
     //! Flag indicating whether initialization tasks have been performed
     bool m_initialized{false};
     //! Flag indicating if complementary comms have been initialized
@@ -41,14 +71,165 @@ private:
     bool m_is_adaptive_holemap_alg{false};
     //! Number of composite bodies
     int m_num_composite_bodies{0};
+    //! Coupling strategy used during time integration
+    CouplingMode m_coupling_mode{CouplingMode::Lockstep};
+    //! Number of near-body sub-steps per background timestep
+    int m_num_substeps{1};
+    //! Order of the fringe extrapolation in time (negative when disabled)
+    int m_extrap_order{-1};
+    //! Maximum number of exchange calls between full exchanges
+    int m_extrap_interval{1};
+    //! Relative drift between extrapolated and exchanged fringe values that
+    //! forces full exchanges
+    double m_extrap_tol{1.0e-2};
+    //! Flag indicating whether the last full exchange exceeded the tolerance
+    bool m_extrap_drift{false};
+    //! Flag indicating whether the drift of the last full exchange is set in
+    //! the iteration batch and not reduced yet
+    bool m_drift_pending{false};
+    //! Flag indicating whether the pending drift is a fringe change between
+    //! two exchanges of the same step
+    bool m_drift_in_step{false};
+    //! Exchange calls served by extrapolation since the last full exchange
+    int m_exchanges_since_full{0};
+    //! Full exchanges since the last connectivity update
+    int m_full_exchanges_since_conn{0};
+    //! Exchange call counts for reporting
+    long m_num_exchange_calls{0};
+    long m_num_skipped_exchanges{0};
+    //! Fringe value history for each solver
+    std::vector<FringeHistory> m_fringe_history;
+    //! Relative change of the fringe values at the last full exchange, from
+    //! the previous exchange of the same step (negative when unknown)
+    double m_fringe_change{-1.0};
+    //! Flag indicating whether the fringe values were recorded in this step
+    bool m_step_exchanged{false};
+    //! Flag indicating whether iteration counts adapt to convergence
+    bool m_adaptive_iterations{false};
+    //! Tolerance on the relative change of the fringe values
+    double m_fringe_tol{1.0e-3};
+    //! Tolerance on the solver nonlinear residuals, set by the user
+    double m_residual_tol{0.0};
+    //! Flag indicating whether any solver reported a residual at the last check
+    bool m_residual_available{false};
+    //! Nonlinear and Picard iterations used during the last step
+    std::array<int, 2> m_iteration_counts{0, 0};
+    //! Lines to write to the timings file with the next finished report
+    std::vector<std::string> m_pending_lines;
+    //! Number of solvers (over all ranks) doing each outer nonlinear
+    //! iteration
+    std::vector<int> m_nonlinear_active;
+    //! Largest number of additional Picard iterations of any solver
+    int m_max_picard_its{0};
+    //! Mesh motion since the last connectivity update (relative to the local
+    //! mesh size) that triggers a new one. Non-positive values update the
+    //! connectivity at every overset update interval.
+    double m_motion_threshold{-1.0};
+    //! Maximum number of steps between motion-triggered connectivity updates
+    int m_max_conn_interval{1};
+    //! Overset update interval of the solvers whose mesh does not move
+    int m_static_update_interval{100000000};
+    //! Timesteps started since the last connectivity update
+    int m_steps_since_conn{0};
+    //! Connectivity update counts for reporting
+    long m_num_conn_checks{0};
+    long m_num_conn_skipped{0};
+    //! Timestep of the last connectivity decision and its outcome
+    int m_conn_decision_step{-1};
+    bool m_conn_decision{true};
+    //! Flag indicating whether connectivity updates are skipped while no
+    //! mesh has changed, including regrids that keep the AMR grids
+    bool m_incremental_conn{false};
+    //! Batched reduction of the mesh motion and of the mesh changes, also
+    //! used for the AMR grid preprocessing flag
+    CollectiveBatch m_motion_batch;
+    int m_motion_slot{-1};
+    int m_changed_slot{-1};
+    int m_preprocess_slot{-1};
+    //! Flag indicating whether connectivity is computed one step ahead on a
+    //! helper thread
+    bool m_lookahead_conn{false};
+    //! Flag indicating whether the next step needs a look-ahead connectivity
+    bool m_lookahead_next{false};
+    //! Flag indicating whether a look-ahead connectivity awaits completion
+    bool m_lookahead_pending{false};
+    //! Flag indicating whether the TIOGA data update runs on a helper
+    //! thread while the solvers do independent work
+    bool m_overlap_exchange{false};
+    //! Flag indicating whether a solution exchange awaits completion
+    bool m_exchange_started{false};
+    //! Flag indicating whether the lagged end of step exchange runs on a
+    //! helper thread into the next step
+    bool m_lagged_overlap{false};
+    //! When each field is exchanged during a timestep
+    ExchangeSchedule m_exchange_schedule;
+    //! Flag indicating whether the next exchange has to include all fields
+    bool m_all_fields_due{true};
+    //! Length of the exchanged field lists, the same for all solvers
+    int m_num_exchange_fields{0};
+    //! Field components of the current exchange without AMR solver
+    int m_exchange_ncomps{0};
+    //! Helper thread running the look-ahead connectivity and the overlapped
+    //! TIOGA data updates
+    HelperThread m_helper;
+    //! Communicator used by TIOGA when it runs on a helper thread
+    MPI_Comm m_tg_comm{MPI_COMM_NULL};
+    //! Scheduler for the solver phases of a timestep
+    PhaseScheduler m_scheduler;
     //! Tioga instance
     TIOGA::tioga m_tg;
-    //! Determine unstructured and structured solver types
-    void check_solver_types();
-    //! Determine if we should update connectivity during time integration
-    void determine_overset_interval();
+    //! Determine the solver types, the interval for connectivity updates
+    //! during time integration and whether all solvers use fixed dt
+    void determine_solver_properties();
     //! Return True if connectivity must be updated at a given timestep
     bool do_connectivity(const int tstep);
+    //! Return True if connectivity must be updated now, accounting for the
+    //! mesh motion since the last update
+    bool connectivity_due(const int tstep);
+    //! Determine whether TIOGA has to preprocess the AMR grid
+    void check_amr_preprocessing();
+    //! TIOGA hole cutting and donor search
+    void tioga_connectivity();
+    //! Finish a connectivity update once TIOGA is done
+    void finish_connectivity();
+    //! Check that the exchanged fields of the solvers line up
+    void validate_exchange_fields();
+    //! TIOGA data update of the registered solutions
+    void tioga_data_update();
+    //! Let TIOGA use its own communicator so that it can run on a helper
+    //! thread
+    void use_tioga_comm();
+    //! Register the meshes at the next step and start their connectivity on
+    //! the helper thread
+    void start_lookahead_connectivity();
+    //! Wait for the look-ahead connectivity and swap it in
+    void complete_lookahead_connectivity();
+    //! Return True if the next exchange can be served by extrapolation
+    bool skip_exchange();
+    //! Overwrite fringe values with their extrapolation in time
+    void extrapolate_fringe_values();
+    //! Store the exchanged fringe values and set their drift for the next
+    //! iteration batch reduction
+    void record_fringe_values();
+    //! Reduce the iteration batch and update the drift dependent flags
+    void reduce_iteration_batch();
+    //! Gather the iteration counts of all solvers
+    void
+    setup_iteration_budgets(const int add_pic_its, const int nonlinear_its);
+    //! Return True if some solver needs the exchange before a nonlinear
+    //! iteration
+    bool exchange_needed(const size_t inonlin) const;
+    //! Largest nonlinear residual of the solvers on this rank
+    double local_residual();
+    //! Return True if the coupled iterations have converged
+    bool check_convergence(const bool use_fringe);
+    //! Advance all solvers together by one timestep
+    void advance_step(
+        const int nt, const int add_pic_its, const int nonlinear_its);
+    //! Advance the background solver by one timestep and the near-body
+    //! solvers by m_num_substeps sub-steps
+    void advance_subcycled_step(
+        const int nt, const int add_pic_its, const int nonlinear_its);
     //! Parallel printer utility
     ParallelPrinter m_printer;
     //! Timer names
@@ -57,6 +238,41 @@ private:
     //! Timer
     Timers m_timers_exa;
     Timers m_timers_tg;
+    //! Interval (in timesteps) for timing and memory reports
+    int m_report_interval{1};
+    //! Timing reductions started but not yet written out
+    std::vector<std::pair<ParallelPrinter, PendingTimings>> m_pending_timings;
+    //! Memory usage gather started but not yet written out
+    long m_mem{0};
+    int m_mem_step{-1};
+    std::vector<long> m_memall;
+    MPI_Request m_mem_request{MPI_REQUEST_NULL};
+    //! Flag indicating whether the memory usage file has been created
+    bool m_memfile_initialized{false};
+    //! Work between synchronization points during the current step
+    IdleTracker m_idle;
+    //! Idle time reduction started but not yet written out
+    std::vector<PendingIdle> m_pending_idle;
+    //! Number of timesteps of the autotuning window (0 when disabled)
+    int m_autotune_window{0};
+    //! Warm-up timesteps before the autotuning window
+    int m_autotune_skip{1};
+    //! File receiving the recommended rank layout
+    std::string m_autotune_file;
+    //! Flag indicating whether the run stops after the autotuning window
+    bool m_autotune_stop{false};
+    //! Timesteps seen by the autotuner so far
+    int m_autotune_steps{0};
+    //! Pre, Solve and Post time of the local solvers during the window (ms)
+    std::vector<double> m_autotune_work;
+    //! Local idle time at synchronization points during the window (ms)
+    double m_autotune_idle{0.0};
+    //! Flag indicating whether the autotuning window is complete
+    bool m_autotune_done{false};
+    //! Accumulate the solver times of a step within the autotuning window
+    void autotune_step();
+    //! Reduce the autotuning measurements and write the recommended layout
+    void finish_autotune();
 
 public:
     OversetSimulation(MPI_Comm comm);
@@ -64,10 +280,11 @@ public:
 
     //! Register a solver
     template <class Solver, class... Args>
-    void register_solver(Args... args)
+    Solver& register_solver(Args... args)
     {
         m_solvers.emplace_back(
             std::make_unique<Solver>(std::forward<Args>(args)..., m_tg));
+        return static_cast<Solver&>(*m_solvers.back());
     }
 
     //! Delete solvers
@@ -84,8 +301,27 @@ public:
     //! Determine field, fringe, hole information
     void perform_overset_connectivity();
 
-    //! Exchange solution between solvers
-    void exchange_solution(const bool increment_time = false);
+    //! Exchange solution between solvers. The flags tell whether this is
+    //! the first and the last exchange of the timestep.
+    void exchange_solution(
+        const bool increment_time = false,
+        const bool first = true,
+        const bool last = true);
+
+    //! Pack the solver data and start the TIOGA data update, on a helper
+    //! thread if overlap is true
+    void begin_exchange(
+        const bool increment_time,
+        const bool overlap,
+        const bool first = true,
+        const bool last = true);
+
+    //! Wait for the data update started by begin_exchange and unpack the
+    //! fringe values
+    void end_exchange();
+
+    //! Wait for the data update started by begin_exchange
+    void wait_exchange();
 
     //! Run prescribed number of timesteps
     void run_timesteps(
@@ -94,14 +330,146 @@ public:
         const int nsteps = 1,
         const double max_time = -1.);
 
+    //! Set the coupling strategy ("lockstep" or "lagged")
+    void set_coupling_mode(const std::string& mode)
+    {
+        if (mode == "lockstep") {
+            m_coupling_mode = CouplingMode::Lockstep;
+        } else if (mode == "lagged") {
+            m_coupling_mode = CouplingMode::Lagged;
+        } else {
+            throw std::runtime_error(
+                "Unknown coupling mode: " + mode +
+                ". Valid options are lockstep and lagged");
+        }
+    }
+
+    //! Update the connectivity only once a moving mesh has moved more than a
+    //! fraction of the local mesh size, or after max_interval steps
+    void set_motion_triggered_connectivity(
+        const double threshold, const int max_interval)
+    {
+        if ((threshold <= 0.0) || (max_interval < 1)) {
+            throw std::runtime_error(
+                "Motion-triggered connectivity requires a positive threshold "
+                "and maximum interval");
+        }
+        m_motion_threshold = threshold;
+        m_max_conn_interval = max_interval;
+    }
+
+    //! Keep the current connectivity while no mesh has changed. A regrid
+    //! that leaves the AMR grid hierarchy unchanged keeps it as well.
+    void set_incremental_connectivity(const bool incremental)
+    {
+        m_incremental_conn = incremental;
+    }
+
+    //! Compute the connectivity of the next step on a helper thread while
+    //! the current step finishes. Requires prescribed mesh motion, fixed
+    //! timestep sizes and MPI_THREAD_MULTIPLE.
+    void set_lookahead_connectivity(const bool lookahead)
+    {
+        m_lookahead_conn = lookahead;
+    }
+
+    //! Exchange the fields at a position of the exchanged field lists at
+    //! every exchange of a timestep ("always"), or only at the first or the
+    //! last one. With adaptive iterations the last exchange is the one
+    //! before the last iteration allowed.
+    void set_exchange_schedule(
+        const int position, const std::string& field, const std::string& when)
+    {
+        m_exchange_schedule.set(position, field, when);
+    }
+
+    //! Run the TIOGA data update on a helper thread while the solvers whose
+    //! stage2 work does not modify the exchanged fields do it (only AMR-Wind
+    //! with amr_wind_overlap_stage2). Requires MPI_THREAD_MULTIPLE.
+    void set_overlap_exchange(const bool overlap)
+    {
+        m_overlap_exchange = overlap;
+    }
+
+    //! Set the number of near-body sub-steps per background timestep
+    void set_num_substeps(const int num_substeps)
+    {
+        if (num_substeps < 1) {
+            throw std::runtime_error(
+                "Number of sub-steps must be a positive integer");
+        }
+        m_num_substeps = num_substeps;
+    }
+
+    //! Replace some solution exchanges with an extrapolation in time of the
+    //! fringe values
+    void set_fringe_extrapolation(
+        const int order, const int exchange_interval, const double tolerance)
+    {
+        if ((order < 0) || (order > 2)) {
+            throw std::runtime_error(
+                "Fringe extrapolation order must be 0, 1 or 2");
+        }
+        if (exchange_interval < 1) {
+            throw std::runtime_error(
+                "Fringe extrapolation exchange interval must be a positive "
+                "integer");
+        }
+        m_extrap_order = order;
+        m_extrap_interval = exchange_interval;
+        m_extrap_tol = tolerance;
+    }
+
+    //! Stop the nonlinear and Picard iterations once converged
+    void set_adaptive_iterations(
+        const double fringe_tolerance, const double residual_tolerance)
+    {
+        m_adaptive_iterations = true;
+        m_fringe_tol = fringe_tolerance;
+        m_residual_tol = residual_tolerance;
+    }
+
     //! Print something
     void echo(const std::string& out) { m_printer.echo(out); }
 
-    //! track detailed timing and print to file
-    void print_timing(const int nt);
+    //! Start non-blocking reductions of timing and memory usage for a step
+    void start_reports(const int nt);
+
+    //! Complete outstanding reductions and write them out
+    void finish_reports();
+
+    //! Progress outstanding reductions, start new ones at the report interval
+    void report_step(const int nt);
 
-    //! track memory usage and print to file
-    long mem_usage_all(const int step);
+    //! Set the interval (in timesteps) for timing and memory reports
+    void set_report_interval(const int interval)
+    {
+        if (interval < 1) {
+            throw std::runtime_error(
+                "Timing output interval must be a positive integer");
+        }
+        m_report_interval = interval;
+    }
+
+    //! Measure the solver times over a window of timesteps, after some
+    //! warm-up steps, and write the rank layout balancing them to a file
+    //! that is applied at the next restart
+    void set_autotune(
+        const int window,
+        const int skip_steps,
+        const std::string& layout_file,
+        const bool stop_after_window)
+    {
+        if ((window < 1) || (skip_steps < 0)) {
+            throw std::runtime_error(
+                "Autotuning requires a positive window and a non-negative "
+                "number of warm-up steps");
+        }
+        m_autotune_window = window;
+        m_autotune_skip = skip_steps;
+        m_autotune_file = layout_file;
+        m_autotune_stop = stop_after_window;
+    }
 
     //! set number of nalu-wind instances
     void set_nw_start_rank(const std::vector<int>& start_ranks)
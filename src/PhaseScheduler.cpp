@@ -0,0 +1,153 @@
+#include "PhaseScheduler.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace exawind {
+
+namespace {
+//! Resource shared by all collective tasks to keep them in program order
+const std::string collective_resource = "__collective__";
+} // namespace
+
+void PhaseScheduler::add_task(
+    const std::string& name,
+    const std::vector<std::string>& inputs,
+    const std::vector<std::string>& outputs,
+    Action action)
+{
+    add(name, inputs, outputs, std::move(action), false);
+}
+
+void PhaseScheduler::add_collective(
+    const std::string& name,
+    const std::vector<std::string>& inputs,
+    const std::vector<std::string>& outputs,
+    Action action)
+{
+    std::vector<std::string> outs(outputs);
+    outs.push_back(collective_resource);
+    add(name, inputs, outs, std::move(action), true);
+}
+
+void PhaseScheduler::add(
+    const std::string& name,
+    std::vector<std::string> inputs,
+    const std::vector<std::string>& outputs,
+    Action action,
+    const bool collective)
+{
+    const int id = static_cast<int>(m_tasks.size());
+    Task task;
+    task.name = name;
+    task.action = std::move(action);
+    task.collective = collective;
+    m_tasks.push_back(std::move(task));
+
+    // read after write
+    for (const auto& res : inputs) {
+        const auto it = m_last_writer.find(res);
+        if (it != m_last_writer.end()) add_edge(it->second, id);
+    }
+    // write after read and write after write
+    for (const auto& res : outputs) {
+        const auto it = m_last_writer.find(res);
+        if (it != m_last_writer.end()) add_edge(it->second, id);
+        auto& readers = m_readers[res];
+        for (const int r : readers) add_edge(r, id);
+        readers.clear();
+    }
+    for (const auto& res : outputs) m_last_writer[res] = id;
+    for (const auto& res : inputs) {
+        if (std::find(outputs.begin(), outputs.end(), res) == outputs.end())
+            m_readers[res].push_back(id);
+    }
+}
+
+void PhaseScheduler::add_edge(const int from, const int to)
+{
+    if (from == to) return;
+    auto& preds = m_tasks[to].preds;
+    if (std::find(preds.begin(), preds.end(), from) != preds.end()) return;
+    preds.push_back(from);
+    m_tasks[from].succs.push_back(to);
+}
+
+std::vector<bool> PhaseScheduler::ancestors(const int task) const
+{
+    std::vector<bool> flags(m_tasks.size(), false);
+    std::vector<int> stack(m_tasks[task].preds);
+    while (!stack.empty()) {
+        const int t = stack.back();
+        stack.pop_back();
+        if (flags[t]) continue;
+        flags[t] = true;
+        stack.insert(
+            stack.end(), m_tasks[t].preds.begin(), m_tasks[t].preds.end());
+    }
+    return flags;
+}
+
+void PhaseScheduler::run()
+{
+    const int ntasks = static_cast<int>(m_tasks.size());
+    std::vector<int> npreds(ntasks);
+    std::vector<bool> done(ntasks, false);
+    for (int i = 0; i < ntasks; ++i) {
+        npreds[i] = static_cast<int>(m_tasks[i].preds.size());
+    }
+
+    std::vector<int> collectives;
+    for (int i = 0; i < ntasks; ++i) {
+        if (m_tasks[i].collective) collectives.push_back(i);
+    }
+    size_t next_coll = 0;
+    std::vector<bool> needed =
+        collectives.empty() ? std::vector<bool>(ntasks, false)
+                            : ancestors(collectives[next_coll]);
+
+    m_order.clear();
+    for (int count = 0; count < ntasks; ++count) {
+        // Local tasks needed by the next collective, then the collective
+        // itself, then any other ready task in program order
+        int pick = -1;
+        int fallback = -1;
+        for (int i = 0; i < ntasks; ++i) {
+            if (done[i] || (npreds[i] > 0) || m_tasks[i].collective) continue;
+            if (needed[i]) {
+                pick = i;
+                break;
+            }
+            if (fallback < 0) fallback = i;
+        }
+        if ((pick < 0) && (next_coll < collectives.size()) &&
+            (npreds[collectives[next_coll]] == 0)) {
+            pick = collectives[next_coll];
+            ++next_coll;
+            if (next_coll < collectives.size()) {
+                needed = ancestors(collectives[next_coll]);
+            } else {
+                std::fill(needed.begin(), needed.end(), false);
+            }
+        }
+        if (pick < 0) pick = fallback;
+        if (pick < 0) {
+            throw std::runtime_error(
+                "PhaseScheduler: cyclic dependency between tasks");
+        }
+
+        m_tasks[pick].action();
+        done[pick] = true;
+        m_order.push_back(m_tasks[pick].name);
+        for (const int s : m_tasks[pick].succs) --npreds[s];
+    }
+    clear();
+}
+
+void PhaseScheduler::clear()
+{
+    m_tasks.clear();
+    m_last_writer.clear();
+    m_readers.clear();
+}
+
+} // namespace exawind
@@ -0,0 +1,83 @@
+#ifndef PHASESCHEDULER_H
+#define PHASESCHEDULER_H
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace exawind {
+
+//! Dependency-graph scheduler for the phases of a timestep
+//!
+//! Tasks are added in program order and declare the resources they read
+//! (inputs) and write (outputs). A task depends on the earlier tasks that
+//! write one of its inputs, and on the earlier tasks that read or write one
+//! of its outputs. Tasks with no path between them can run in any order.
+//!
+//! Collective tasks (exchanges, connectivity, reductions) involve all ranks
+//! and run in program order on every rank. Between two collectives the
+//! scheduler first runs the local tasks the next collective depends on, so
+//! that a rank reaches each synchronization point as early as possible, and
+//! defers the other ready tasks.
+class PhaseScheduler
+{
+public:
+    using Action = std::function<void()>;
+
+    //! Add a task local to this rank
+    void add_task(
+        const std::string& name,
+        const std::vector<std::string>& inputs,
+        const std::vector<std::string>& outputs,
+        Action action);
+
+    //! Add a task that all ranks execute together
+    void add_collective(
+        const std::string& name,
+        const std::vector<std::string>& inputs,
+        const std::vector<std::string>& outputs,
+        Action action);
+
+    //! Run all tasks and clear the graph
+    void run();
+
+    //! Remove all tasks
+    void clear();
+
+    //! Names of the tasks in the order of the last run
+    const std::vector<std::string>& execution_order() const
+    {
+        return m_order;
+    }
+
+private:
+    struct Task
+    {
+        std::string name;
+        Action action;
+        bool collective{false};
+        std::vector<int> preds;
+        std::vector<int> succs;
+    };
+
+    void add(
+        const std::string& name,
+        std::vector<std::string> inputs,
+        const std::vector<std::string>& outputs,
+        Action action,
+        const bool collective);
+
+    void add_edge(const int from, const int to);
+
+    //! Flag the tasks the given task depends on, directly or not
+    std::vector<bool> ancestors(const int task) const;
+
+    std::vector<Task> m_tasks;
+    std::unordered_map<std::string, int> m_last_writer;
+    std::unordered_map<std::string, std::vector<int>> m_readers;
+    std::vector<std::string> m_order;
+};
+
+} // namespace exawind
+#endif /* PHASESCHEDULER_H */
@@ -2,6 +2,7 @@
 #define TIMERS_H
 
 #include "mpi.h"
+#include <array>
 #include <vector>
 #include <algorithm>
 #include <chrono>
@@ -39,12 +40,113 @@ public:
         _increment = duration();
     }
 
+    //! Forget the last duration, the next incremental tick starts over
+    void reset()
+    {
+        _start = TimePt{};
+        _end = TimePt{};
+        _increment = TimeT::zero();
+    }
+
     TimeT duration() const
     {
         return std::chrono::duration_cast<TimeT>(_end - _start);
     }
 };
 
+//! Non-blocking min/avg/max reduction of a snapshot of per-rank values
+//!
+//! The min and the max are reduced together as the max of the negated and
+//! the original values, so only two reductions are in flight.
+//!
+//! The reduction buffers live on the heap, so an in-flight reduction can be
+//! moved (e.g., stored in a std::vector) but must not be copied.
+struct AsyncMinAvgMax
+{
+    std::vector<double> m_local;
+    std::vector<double> m_minmax_local;
+    std::vector<double> m_minmax;
+    std::vector<double> m_min;
+    std::vector<double> m_avg;
+    std::vector<double> m_max;
+    std::array<MPI_Request, 2> m_requests{MPI_REQUEST_NULL, MPI_REQUEST_NULL};
+    int m_psize{1};
+    bool m_done{true};
+
+    void start(const std::vector<double>& values, MPI_Comm comm, int root)
+    {
+        // the send buffers have to outlive the reduction, keep our own copy
+        m_local = values;
+        const int n = static_cast<int>(m_local.size());
+        m_minmax_local.resize(2 * n);
+        for (int i = 0; i < n; ++i) {
+            m_minmax_local[i] = -m_local[i];
+            m_minmax_local[n + i] = m_local[i];
+        }
+        m_minmax.assign(2 * n, 0.0);
+        m_min.assign(n, 0.0);
+        m_avg.assign(n, 0.0);
+        m_max.assign(n, 0.0);
+        MPI_Comm_size(comm, &m_psize);
+        MPI_Ireduce(
+            m_minmax_local.data(), m_minmax.data(), 2 * n, MPI_DOUBLE, MPI_MAX,
+            root, comm, &m_requests[0]);
+        MPI_Ireduce(
+            m_local.data(), m_avg.data(), n, MPI_DOUBLE, MPI_SUM, root, comm,
+            &m_requests[1]);
+        m_done = false;
+    }
+
+    //! Progress the reduction, return true once it has completed
+    bool test()
+    {
+        if (m_done) return true;
+        int flag = 0;
+        MPI_Testall(
+            static_cast<int>(m_requests.size()), m_requests.data(), &flag,
+            MPI_STATUSES_IGNORE);
+        if (flag != 0) finish();
+        return m_done;
+    }
+
+    void wait()
+    {
+        if (m_done) return;
+        MPI_Waitall(
+            static_cast<int>(m_requests.size()), m_requests.data(),
+            MPI_STATUSES_IGNORE);
+        finish();
+    }
+
+private:
+    void finish()
+    {
+        const size_t n = m_avg.size();
+        for (size_t i = 0; i < n; ++i) {
+            m_min[i] = -m_minmax[i];
+            m_max[i] = m_minmax[n + i];
+        }
+        for (auto& elem : m_avg) {
+            elem /= m_psize;
+        }
+        m_done = true;
+    }
+};
+
+//! Timings of one set of timers whose reduction may still be in flight
+struct PendingTimings
+{
+    std::string solver;
+    int step{0};
+    std::vector<std::string> names;
+    AsyncMinAvgMax times;
+
+    //! Total line, only meaningful on the root rank after wait()
+    std::string summary() const;
+    //! Per timer lines, only meaningful on the root rank after wait()
+    std::string detail() const;
+};
+
 struct Timers
 {
     std::vector<Timer> m_timers;
@@ -81,6 +183,15 @@ struct Timers
 
     void tock(const std::string name) { m_timers.at(idx(name)).tock(); };
 
+    //! Reset a timer, if it exists
+    void reset(const std::string& name)
+    {
+        const auto itr = std::find(m_names.begin(), m_names.end(), name);
+        if (itr != m_names.end()) {
+            m_timers.at(std::distance(m_names.begin(), itr)).reset();
+        }
+    };
+
     int idx(const std::string key)
     {
         std::vector<std::string>::iterator itr =
@@ -109,35 +220,72 @@ struct Timers
         std::vector<double> maxtimes(m_timers.size(), 0.0);
         par_reduce_times(mintimes, avgtimes, maxtimes, comm, root);
 
+        return get_detail_output(
+            solver, step, m_names, mintimes, avgtimes, maxtimes);
+    };
+
+    //! Start a non-blocking reduction of the current timer counts
+    PendingTimings start_timings_reduction(
+        std::string solver, int step, MPI_Comm comm, int root = 0)
+    {
+        PendingTimings pending;
+        pending.solver = solver;
+        pending.step = step;
+        pending.names = m_names;
+        pending.times.start(counts(), comm, root);
+        return pending;
+    };
+
+    static std::string get_detail_output(
+        const std::string& solver,
+        int step,
+        const std::vector<std::string>& names,
+        const std::vector<double>& mintimes,
+        const std::vector<double>& avgtimes,
+        const std::vector<double>& maxtimes)
+    {
         std::ostringstream outstream;
         std::ostringstream linestream;
-        for (int i = 0; i < static_cast<int>(m_timers.size()); ++i) {
-            std::string func_call =
-                (m_timers.size() == 1) ? "Total" : m_names.at(i);
+        for (int i = 0; i < static_cast<int>(names.size()); ++i) {
+            std::string func_call = (names.size() == 1) ? "Total" : names.at(i);
 
             linestream = get_line_output(
                 solver, step, func_call, mintimes.at(i), avgtimes.at(i),
                 maxtimes.at(i));
 
             outstream << linestream.str();
-            if (i < static_cast<int>(m_timers.size()) - 1)
+            if (i < static_cast<int>(names.size()) - 1)
                 outstream << std::endl;
         }
 
         //  accumulate only if there is more than 1 routine to report
-        if (m_timers.size() > 1) {
-            double total_min, total_avg, total_max;
-            total_times(total_min, total_avg, total_max, comm, root);
-
+        if (names.size() > 1) {
             outstream << std::endl;
-            linestream = get_line_output(
-                solver, step, "Total", total_min, total_avg, total_max);
-            outstream << linestream.str();
+            outstream << get_total_output(
+                solver, step, mintimes, avgtimes, maxtimes);
         }
 
         return outstream.str();
     };
 
+    static std::string get_total_output(
+        const std::string& solver,
+        int step,
+        const std::vector<double>& mintimes,
+        const std::vector<double>& avgtimes,
+        const std::vector<double>& maxtimes)
+    {
+        const double total_min =
+            std::accumulate(mintimes.begin(), mintimes.end(), 0.0);
+        const double total_avg =
+            std::accumulate(avgtimes.begin(), avgtimes.end(), 0.0);
+        const double total_max =
+            std::accumulate(maxtimes.begin(), maxtimes.end(), 0.0);
+        return get_line_output(
+                   solver, step, "Total", total_min, total_avg, total_max)
+            .str();
+    };
+
     void total_times(
         double& total_min,
         double& total_avg,
@@ -151,7 +299,7 @@ struct Timers
         par_reduce_times(mintimes, avgtimes, maxtimes, comm, root);
 
         total_min = std::accumulate(mintimes.begin(), mintimes.end(), 0.0);
-        total_avg = std::accumulate(mintimes.begin(), mintimes.end(), 0.0);
+        total_avg = std::accumulate(avgtimes.begin(), avgtimes.end(), 0.0);
         total_max = std::accumulate(maxtimes.begin(), maxtimes.end(), 0.0);
     }
 
@@ -180,16 +328,16 @@ struct Timers
         }
     }
 
-    std::ostringstream get_line_output(
+    static std::ostringstream get_line_output(
         std::string solver,
         int step,
         std::string func_call,
         double min,
         double avg,
-        double max)
+        double max,
+        const double ms2s = 1000.0)
     {
         std::ostringstream outstream;
-        const double ms2s = 1000.0;
         const char separator = ' ';
         const int name_width = 25;
         const int num_width = 10;
@@ -212,5 +360,17 @@ struct Timers
         return outstream;
     }
 };
+
+inline std::string PendingTimings::summary() const
+{
+    return Timers::get_total_output(
+        solver, step, times.m_min, times.m_avg, times.m_max);
+}
+
+inline std::string PendingTimings::detail() const
+{
+    return Timers::get_detail_output(
+        solver, step, names, times.m_min, times.m_avg, times.m_max);
+}
 } // namespace exawind
 #endif /* TIMERS_H */
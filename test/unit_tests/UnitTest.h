@@ -0,0 +1,47 @@
+#ifndef UNITTEST_H
+#define UNITTEST_H
+
+#include <cmath>
+#include <iostream>
+#include <string>
+
+namespace exawind {
+namespace unit_test {
+
+//! Number of failed checks of the test executable
+inline int& num_failures()
+{
+    static int failures = 0;
+    return failures;
+}
+
+//! Report a failed check, the test keeps running
+inline void check(const bool condition, const std::string& what)
+{
+    if (condition) return;
+    std::cerr << "FAILED: " << what << std::endl;
+    ++num_failures();
+}
+
+inline void check_near(
+    const double value, const double expected, const std::string& what)
+{
+    check(
+        std::abs(value - expected) <= 1.0e-10 * (1.0 + std::abs(expected)),
+        what + ": got " + std::to_string(value) + ", expected " +
+            std::to_string(expected));
+}
+
+//! Exit status of the test executable
+inline int result()
+{
+    if (num_failures() > 0) {
+        std::cerr << num_failures() << " checks failed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+} // namespace unit_test
+} // namespace exawind
+#endif /* UNITTEST_H */
@@ -0,0 +1,126 @@
+#include "PhaseScheduler.h"
+#include "UnitTest.h"
+#include <stdexcept>
+
+using namespace exawind;
+using unit_test::check;
+
+namespace {
+
+using Names = std::vector<std::string>;
+
+//! Task that records its name when it runs
+PhaseScheduler::Action record(Names& ran, const std::string& name)
+{
+    return [&ran, name]() { ran.push_back(name); };
+}
+
+void test_read_after_write()
+{
+    // The collective only needs the writer of its input, the other local
+    // task is deferred past the synchronization point
+    Names ran;
+    PhaseScheduler sched;
+    sched.add_task("other", {}, {"a"}, record(ran, "other"));
+    sched.add_task("write", {}, {"x"}, record(ran, "write"));
+    sched.add_collective("coll", {"x"}, {}, record(ran, "coll"));
+    sched.run();
+    check(ran == Names({"write", "coll", "other"}), "read after write");
+    check(sched.execution_order() == ran, "execution order");
+}
+
+void test_write_after_read()
+{
+    Names ran;
+    PhaseScheduler sched;
+    sched.add_task("other", {}, {"a"}, record(ran, "other"));
+    sched.add_task("read", {"x"}, {}, record(ran, "read"));
+    sched.add_collective("coll", {}, {"x"}, record(ran, "coll"));
+    sched.run();
+    check(ran == Names({"read", "coll", "other"}), "write after read");
+}
+
+void test_write_after_write()
+{
+    // The task reading the first value of x runs before the second write,
+    // the task reading the second value after it
+    Names ran;
+    PhaseScheduler sched;
+    sched.add_task("write", {}, {"x"}, record(ran, "write"));
+    sched.add_task("read_first", {"x"}, {"a"}, record(ran, "read_first"));
+    sched.add_collective("coll", {}, {"x"}, record(ran, "coll"));
+    sched.add_task("read_second", {"x"}, {"b"}, record(ran, "read_second"));
+    sched.run();
+    check(
+        ran == Names({"write", "read_first", "coll", "read_second"}),
+        "write after write");
+}
+
+void test_transitive_dependencies()
+{
+    Names ran;
+    PhaseScheduler sched;
+    sched.add_task("other", {}, {"b"}, record(ran, "other"));
+    sched.add_task("first", {}, {"x"}, record(ran, "first"));
+    sched.add_task("second", {"x"}, {"y"}, record(ran, "second"));
+    sched.add_collective("coll", {"y"}, {}, record(ran, "coll"));
+    sched.run();
+    check(
+        ran == Names({"first", "second", "coll", "other"}),
+        "indirect dependencies run before the collective");
+}
+
+void test_collective_order()
+{
+    // Collectives keep their program order even when a later one is ready
+    // first, the local tasks run in program order between them
+    Names ran;
+    PhaseScheduler sched;
+    sched.add_task("local0", {}, {"x"}, record(ran, "local0"));
+    sched.add_collective("coll0", {"x"}, {}, record(ran, "coll0"));
+    sched.add_collective("coll1", {}, {}, record(ran, "coll1"));
+    sched.add_task("local1", {}, {"y"}, record(ran, "local1"));
+    sched.add_collective("coll2", {"y"}, {}, record(ran, "coll2"));
+    sched.add_task("local2", {}, {"z"}, record(ran, "local2"));
+    sched.run();
+    check(
+        ran == Names({"local0", "coll0", "coll1", "local1", "coll2", "local2"}),
+        "collectives in program order");
+
+    // The graph is cleared by the run
+    sched.run();
+    check(sched.execution_order().empty(), "graph cleared after a run");
+}
+
+void test_no_cycles()
+{
+    // Dependencies only point to earlier tasks, so tasks that read what a
+    // later task writes and the other way around do not form a cycle
+    Names ran;
+    PhaseScheduler sched;
+    sched.add_task("a", {"x"}, {"y"}, record(ran, "a"));
+    sched.add_task("b", {"y"}, {"x"}, record(ran, "b"));
+    sched.add_collective("coll", {"x", "y"}, {"x", "y"}, record(ran, "coll"));
+    sched.add_task("c", {"x"}, {"x"}, record(ran, "c"));
+    bool threw = false;
+    try {
+        sched.run();
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    check(!threw, "no cyclic dependency reported");
+    check(ran == Names({"a", "b", "coll", "c"}), "program order kept");
+}
+
+} // namespace
+
+int main()
+{
+    test_read_after_write();
+    test_write_after_read();
+    test_write_after_write();
+    test_transitive_dependencies();
+    test_collective_order();
+    test_no_cycles();
+    return unit_test::result();
+}
@@ -0,0 +1,119 @@
+#include "StepSimulator.h"
+#include "TimingData.h"
+#include "UnitTest.h"
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+using namespace exawind;
+using unit_test::check;
+using unit_test::check_near;
+
+namespace {
+
+void test_timing_data(const std::string& filename)
+{
+    const TimingData data(filename, 1);
+    check(data.num_steps() == 2, "two steps left after skipping one");
+
+    // The first step is left out of the statistics
+    const auto step = data.phase("Exawind", "TimeStep");
+    check_near(step.max, 3.1, "mean step time");
+    check_near(step.last, 3.2, "step time of the last step");
+    check(step.num_steps == 2, "steps of the step timer");
+    check_near(data.phase("Nalu-Wind-1", "Pre").avg, 0.35, "rank average");
+
+    check(data.has_phase("AMR-Wind", "Post"), "recorded timer");
+    check(!data.has_phase("AMR-Wind", "Fringe"), "timer not recorded");
+    check_near(data.phase("AMR-Wind", "Fringe").max, 0.0, "missing timer");
+
+    const auto solvers = data.solvers();
+    check(
+        (solvers.size() == 2) && (solvers[0] == "Nalu-Wind-1") &&
+            (solvers[1] == "AMR-Wind"),
+        "solvers in registration order");
+}
+
+void test_step_simulator(const std::string& filename)
+{
+    const TimingData data(filename, 1);
+    const auto recorded = RunConfig::read(
+        YAML::Load("{mpi_ranks: 2, ranks: {AMR-Wind: 1, Nalu-Wind-1: 1}, "
+                   "nonlinear_iterations: 2, connectivity_interval: 2}"),
+        RunConfig());
+    const StepSimulator sim(data, recorded, 1.0);
+    check_near(sim.recorded_step_time(), 3.1, "recorded step time");
+
+    // The connectivity and exchange packing timers are per event, the
+    // iteration and exchange timers hold the total of a step. The first
+    // step updates the connectivity:
+    //   iteration 0: AMR-Wind 0.1 / Nalu-Wind 0.2 stage work, 0.02 PreConn,
+    //     connectivity until 0.52, 0.02 PostConn, exchange (0.05 + 0.1 +
+    //     0.05) until 0.74, AMR-Wind solves until 1.74
+    //   iteration 1: AMR-Wind stage work until 1.84, exchange until 2.04,
+    //     AMR-Wind solves until 3.04 and post-processes until 3.14
+    const auto pred = sim.predict(recorded, 1);
+    check_near(pred.step_time, 3.14, "predicted step time");
+    // Busy time is the sum of the solver phases: 2 x stage work, connectivity
+    // work, 2 x (packing + unpacking), solves and post-processing
+    check_near(pred.busy.at("AMR-Wind"), 2.54, "AMR-Wind busy");
+    check_near(pred.busy.at("Nalu-Wind-1"), 1.74, "Nalu-Wind busy");
+
+    // Twice the ranks halve the solver phases with linear scaling
+    auto config = RunConfig::read(
+        YAML::Load("{mpi_ranks: 3, ranks: {AMR-Wind: 2}}"), recorded);
+    check_near(
+        sim.predict(config, 1).busy.at("AMR-Wind"), 0.5 * 2.54,
+        "AMR-Wind busy on twice the ranks");
+
+    bool thrown = false;
+    try {
+        config = RunConfig::read(YAML::Load("{mpi_ranks: 4}"), recorded);
+        sim.predict(config, 1);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    check(thrown, "ranks not covered by the solvers");
+}
+
+//! The exawind driver labels its single step timer Total
+void test_total_label(const std::string& filename)
+{
+    const auto copy =
+        std::filesystem::temp_directory_path() / "exawind_sim_total.dat";
+    {
+        std::ifstream inp(filename);
+        std::ofstream out(copy);
+        std::string line;
+        const std::string label = "Exawind::TimeStep";
+        while (std::getline(inp, line)) {
+            if (line.rfind(label, 0) == 0) {
+                line = "Exawind::Total" + line.substr(label.size());
+            }
+            out << line << std::endl;
+        }
+    }
+    const TimingData data(copy.string(), 1);
+    std::filesystem::remove(copy);
+    const StepSimulator sim(
+        data,
+        RunConfig::read(
+            YAML::Load("{mpi_ranks: 2, ranks: {AMR-Wind: 1, Nalu-Wind-1: 1}}"),
+            RunConfig()),
+        1.0);
+    check_near(sim.recorded_step_time(), 3.1, "step time labelled Total");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc != 2) {
+        std::cerr << "usage: " << argv[0] << " timings_file" << std::endl;
+        return 1;
+    }
+    test_timing_data(argv[1]);
+    test_step_simulator(argv[1]);
+    test_total_label(argv[1]);
+    return unit_test::result();
+}